@@ -0,0 +1,356 @@
+#include <opencv2/opencv.hpp>
+#include <opencv2/features2d.hpp>
+#include <vulkan/vulkan.h>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <functional>
+#include "VulkanSetup.h"
+#include "FastDetector.h"
+#include "CpuFastDetector.h"
+
+// FAST benchmark over synthetic images: several resolutions x corner densities,
+// GPU backend (per-stage timestamps), CPU backend and cv::FAST as reference.
+//
+//   fast_bench [--iters=N] [--warmup=N] [--inflight=K] [--nms] [--grid=C[xK]]
+//              [--levels=L] [--format=r8ui|r8|rgba8] [--sizes=WxH,...] [--csv=file]
+//              [--backend=all|gpu|cpu|opencv] [--pipeline-cache=file] [--threshold=T]
+//              [--zero-copy] [--device=N] [--dedicated-queues] [--orb] [--mask=F] [--tiled]
+//
+// --tiled runs the GPU rows on the shared-memory tiled FAST kernel
+// (Options::tiled) instead of the per-pixel one.
+//
+// --mask=F restricts the GPU rows to a band over the left fraction F of every
+// frame (Options::tileMask, indirect dispatch over the active tiles), so the
+// fast column can be compared against an unmasked run.
+//
+// --zero-copy feeds the GPU through submitImported()/collectInto() (imported host
+// memory, no staging memcpy) instead of detect()/submit(). The frames are copied
+// into one buffer registered with registerHostBuffer().
+//
+// Runs on any Vulkan ICD, e.g. Mesa's lavapipe for CI machines without a GPU:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./fast_bench --iters=20
+// Validation layers stay off so they do not end up in the numbers.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Copy of `img` at `base`, the start of the buffer registered for --zero-copy
+cv::Mat importableCopy(const cv::Mat& img, uint8_t* base) {
+    cv::Mat aligned(img.rows, img.cols, img.type(), base);
+    img.copyTo(aligned);
+    return aligned;
+}
+
+// Flat noisy background with `rectsPerMP` random filled rectangles per megapixel;
+// every rectangle contributes four FAST corners (fewer where they overlap)
+cv::Mat syntheticImage(int w, int h, int rectsPerMP, uint64_t seed) {
+    cv::RNG rng(seed);
+    cv::Mat img(h, w, CV_8UC1, cv::Scalar(128));
+    cv::Mat noise(h, w, CV_8UC1);
+    rng.fill(noise, cv::RNG::NORMAL, 0, 4);
+    img += noise;
+    const int rects = std::max(1, int(double(w) * h * 1e-6 * rectsPerMP));
+    for (int i = 0; i < rects; ++i) {
+        const int rw = rng.uniform(8, 48), rh = rng.uniform(8, 48);
+        const int x = rng.uniform(0, std::max(1, w - rw)), y = rng.uniform(0, std::max(1, h - rh));
+        const int v = rng.uniform(0, 2) ? rng.uniform(0, 40) : rng.uniform(215, 256);
+        cv::rectangle(img, cv::Rect(x, y, rw, rh), cv::Scalar(v), cv::FILLED);
+    }
+    return img;
+}
+
+double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    const size_t i = std::min(v.size() - 1, size_t(p * double(v.size() - 1) + 0.5));
+    return v[i];
+}
+
+struct Result {
+    std::string backend, density;
+    int width = 0, height = 0;
+    size_t keypoints = 0;
+    double p50 = 0, p90 = 0, p99 = 0, mps = 0;
+    double streamFps = 0;          // GPU only: throughput with framesInFlight slots
+    FastDetector::Timings stages;  // GPU only: mean per-stage times
+};
+
+// Latency distribution of `iters` calls of fn after `warmup` untimed ones
+std::vector<double> timeCalls(int warmup, int iters, const std::function<void()>& fn) {
+    for (int i = 0; i < warmup; ++i) fn();
+    std::vector<double> ms;
+    ms.reserve(size_t(iters));
+    for (int i = 0; i < iters; ++i) {
+        auto t0 = Clock::now();
+        fn();
+        ms.push_back(msSince(t0));
+    }
+    return ms;
+}
+
+void fillLatency(Result& r, const std::vector<double>& ms) {
+    r.p50 = percentile(ms, 0.50);
+    r.p90 = percentile(ms, 0.90);
+    r.p99 = percentile(ms, 0.99);
+    r.mps = r.p50 > 0 ? double(r.width) * r.height * 1e-6 / (r.p50 * 1e-3) : 0.0;
+}
+
+void printRow(const Result& r) {
+    std::printf("%-7s %5dx%-5d %-6s %8zu %8.3f %8.3f %8.3f %9.1f", r.backend.c_str(), r.width, r.height,
+                r.density.c_str(), r.keypoints, r.p50, r.p90, r.p99, r.mps);
+    if (r.backend.rfind("gpu", 0) == 0) {   // gpu and gpu-zc
+        const FastDetector::Timings& t = r.stages;
+        std::printf("  | fps %7.1f | host up %.3f wait %.3f rb %.3f | gpu up %.3f pyr %.3f trk %.3f fast %.3f sel %.3f orb %.3f ovl %.3f tot %.3f",
+                    r.streamFps, t.hostUpload, t.hostWait, t.hostReadback,
+                    t.gpuUpload, t.gpuPyramid, t.gpuTrack, t.gpuDetect, t.gpuSelect, t.gpuDescribe, t.gpuOverlay, t.gpuTotal);
+    }
+    std::printf("\n");
+}
+
+void writeCsv(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream out(path);
+    out << "backend,width,height,density,keypoints,p50_ms,p90_ms,p99_ms,mpix_per_s,stream_fps,"
+           "host_upload_ms,host_wait_ms,host_readback_ms,gpu_upload_ms,gpu_pyramid_ms,gpu_track_ms,gpu_detect_ms,"
+           "gpu_select_ms,gpu_describe_ms,gpu_overlay_ms,gpu_total_ms\n";
+    for (const Result& r : results) {
+        const FastDetector::Timings& t = r.stages;
+        out << r.backend << ',' << r.width << ',' << r.height << ',' << r.density << ',' << r.keypoints << ','
+            << r.p50 << ',' << r.p90 << ',' << r.p99 << ',' << r.mps << ',' << r.streamFps << ','
+            << t.hostUpload << ',' << t.hostWait << ',' << t.hostReadback << ',' << t.gpuUpload << ','
+            << t.gpuPyramid << ',' << t.gpuTrack << ',' << t.gpuDetect << ',' << t.gpuSelect << ',' << t.gpuDescribe << ',' << t.gpuOverlay << ','
+            << t.gpuTotal << '\n';
+    }
+    std::cout << "Wrote " << path << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FastDetector::Options detOpts;
+    detOpts.profile = true;
+    int iters = 200, warmup = 20;
+    std::string backend = "all", csv;
+    bool zeroCopy = false;
+    double maskFraction = 1.0;
+    int device = -1;
+    bool dedicatedQueues = false;
+    std::vector<cv::Size> sizes = {{640, 480}, {1280, 720}, {1920, 1080}, {3840, 2160}};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--nms") detOpts.nonmaxSuppression = true;
+        else if (arg == "--tiled") detOpts.tiled = true;
+        else if (arg == "--zero-copy") zeroCopy = true;
+        else if (arg == "--orb") detOpts.orb = true;
+        else if (arg == "--dedicated-queues") dedicatedQueues = true;
+        else if (arg.rfind("--device=", 0) == 0) device = std::atoi(arg.c_str() + 9);
+        else if (arg.rfind("--mask=", 0) == 0) {
+            maskFraction = std::min(1.0, std::max(0.0, std::atof(arg.c_str() + 7)));
+            detOpts.tileMask = true;
+        }
+        else if (arg.rfind("--iters=", 0) == 0) iters = std::max(1, std::atoi(arg.c_str() + 8));
+        else if (arg.rfind("--warmup=", 0) == 0) warmup = std::max(0, std::atoi(arg.c_str() + 9));
+        else if (arg.rfind("--inflight=", 0) == 0) detOpts.framesInFlight = uint32_t(std::max(1, std::atoi(arg.c_str() + 11)));
+        else if (arg.rfind("--levels=", 0) == 0) detOpts.pyramidLevels = uint32_t(std::max(1, std::atoi(arg.c_str() + 9)));
+        else if (arg.rfind("--backend=", 0) == 0) backend = arg.substr(10);
+        else if (arg.rfind("--csv=", 0) == 0) csv = arg.substr(6);
+        else if (arg.rfind("--pipeline-cache=", 0) == 0) detOpts.pipelineCache = arg.substr(17);
+        else if (arg.rfind("--threshold=", 0) == 0) detOpts.threshold = uint32_t(std::max(0, std::atoi(arg.c_str() + 12)));
+        else if (arg.rfind("--grid=", 0) == 0) {
+            if (std::sscanf(arg.c_str() + 7, "%ux%u", &detOpts.gridCell, &detOpts.gridTopK) < 1) {
+                std::cerr << "Invalid " << arg << ", expected --grid=C or --grid=CxK" << std::endl;
+                return -1;
+            }
+        }
+        else if (arg.rfind("--format=", 0) == 0) {
+            std::string f = arg.substr(9);
+            if (f == "r8ui") detOpts.inputFormat = FastDetector::InputFormat::R8UInt;
+            else if (f == "r8") detOpts.inputFormat = FastDetector::InputFormat::R8UNorm;
+            else if (f == "rgba8") detOpts.inputFormat = FastDetector::InputFormat::RGBA8;
+            else std::cerr << "Unknown " << arg << ", using r8ui" << std::endl;
+        }
+        else if (arg.rfind("--sizes=", 0) == 0) {
+            sizes.clear();
+            const char* p = arg.c_str() + 8;
+            int w = 0, h = 0, n = 0;
+            while (std::sscanf(p, "%dx%d%n", &w, &h, &n) == 2) {
+                sizes.emplace_back(w, h);
+                p += n;
+                if (*p != ',') break;
+                ++p;
+            }
+        }
+        else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return -1;
+        }
+    }
+    const bool runGpu = backend == "all" || backend == "gpu";
+    const bool runCpu = backend == "all" || backend == "cpu";
+    const bool runOpenCV = backend == "all" || backend == "opencv";
+
+    std::unique_ptr<VulkanSetup> vk;
+    std::unique_ptr<FastDetector> gpu;
+    if (runGpu) {
+        VulkanSetup::Options opts;
+        opts.appName = "FastBench";
+        opts.apiVersion = VK_API_VERSION_1_2;
+        opts.enableValidation = false;
+        opts.deviceIndex = device;
+        opts.dedicatedQueues = dedicatedQueues;
+        try {
+            vk = std::make_unique<VulkanSetup>(opts);
+            std::cout << "Device " << vk->deviceName()
+                      << (vk->transferQueueFamily() != vk->computeQueueFamily() ? " (dedicated transfer queue)" : "") << "\n";
+            auto t0 = Clock::now();
+            gpu = std::make_unique<FastDetector>(*vk, detOpts);
+            std::cout << "FastDetector setup " << msSince(t0) << " ms"
+                      << (detOpts.pipelineCache.empty() ? "" : " (pipeline cache " + detOpts.pipelineCache + ")") << "\n";
+            if (!gpu->hasGpuTimestamps()) std::cerr << "GPU stage columns are 0 (no timestamp support)" << std::endl;
+        } catch (const std::exception& e) {
+            if (backend == "gpu") throw;
+            std::cerr << "Skipping GPU backend: " << e.what() << std::endl;
+        }
+    }
+
+    CpuFastDetector::Options cpuOpts;
+    cpuOpts.threshold = detOpts.threshold;
+    cpuOpts.nonmaxSuppression = detOpts.nonmaxSuppression;
+    cpuOpts.gridCell = detOpts.gridCell;
+    cpuOpts.gridTopK = detOpts.gridTopK;
+    cpuOpts.maxKeypoints = detOpts.maxKeypoints;
+    cpuOpts.pyramidLevels = detOpts.pyramidLevels;
+    cpuOpts.pyramidScale = detOpts.pyramidScale;
+    std::unique_ptr<CpuFastDetector> cpu;
+    if (runCpu) cpu = std::make_unique<CpuFastDetector>(cpuOpts);
+
+    std::cout << "iters " << iters << ", warmup " << warmup << ", inflight " << detOpts.framesInFlight
+              << (detOpts.tileMask ? ", gpu mask " + std::to_string(int(maskFraction * 100 + 0.5)) + "%" : "")
+              << (cpu ? std::string(", cpu ") + cpu->simd() + " x" + std::to_string(cpu->threads()) : "")
+              << "\n";
+    std::printf("%-7s %11s %-6s %8s %8s %8s %8s %9s\n", "backend", "size", "dens", "kps", "p50 ms", "p90 ms", "p99 ms", "MP/s");
+
+    struct Density { const char* name; int rectsPerMP; };
+    const Density densities[] = {{"low", 20}, {"medium", 200}, {"high", 2000}};
+
+    // --zero-copy: one aligned buffer for the largest frame, imported once and
+    // released before it is freed, so no import outlives the memory it maps
+    std::vector<uint8_t> storage;
+    uint8_t* importBase = nullptr;
+    if (gpu && zeroCopy) {
+        const size_t alignment = std::max<size_t>(gpu->importAlignment(), 64);
+        size_t bytes = 0;
+        for (const cv::Size& size : sizes) bytes = std::max(bytes, size_t(size.area()));
+        bytes = (bytes + alignment - 1) / alignment * alignment;
+        storage.assign(bytes + alignment, 0);
+        const size_t misalign = reinterpret_cast<uintptr_t>(storage.data()) % alignment;
+        importBase = storage.data() + (misalign ? alignment - misalign : 0);
+        gpu->registerHostBuffer(importBase, bytes);   // false: submitImported() falls back per frame
+    }
+
+    std::vector<Result> results;
+    for (const cv::Size& size : sizes) {
+        for (const Density& d : densities) {
+            const cv::Mat img = syntheticImage(size.width, size.height, d.rectsPerMP, uint64_t(size.area()) + d.rectsPerMP);
+            Result base;
+            base.density = d.name;
+            base.width = size.width;
+            base.height = size.height;
+
+            if (gpu) {
+                Result r = base;
+                r.backend = zeroCopy ? "gpu-zc" : "gpu";
+                FastDetector::Timings sum;
+                int calls = 0, samples = 0;
+                // Zero-copy: the registered frame buffer and a keypoint array reused by every call
+                const cv::Mat src = zeroCopy ? importableCopy(img, importBase) : img;
+                std::vector<Keypoint> kps(zeroCopy ? detOpts.maxKeypoints : 0);
+                if (detOpts.tileMask) {
+                    cv::Mat mask(size, CV_8UC1, cv::Scalar(0));
+                    mask(cv::Rect(0, 0, int(size.width * maskFraction + 0.5), size.height)).setTo(cv::Scalar(255));
+                    gpu->setDetectionMask(mask);
+                }
+                auto detect = [&] {
+                    if (!zeroCopy) return gpu->detect(src).size();
+                    gpu->submitImported(src);
+                    return gpu->collectInto(kps.data(), kps.size());
+                };
+                const std::vector<double> ms = timeCalls(warmup, iters, [&] {
+                    r.keypoints = detect();
+                    if (++calls <= warmup) return;   // stage means over the timed iterations only
+                    const FastDetector::Timings& t = gpu->timings();
+                    sum.hostUpload += t.hostUpload; sum.hostWait += t.hostWait; sum.hostReadback += t.hostReadback;
+                    sum.gpuUpload += t.gpuUpload; sum.gpuPyramid += t.gpuPyramid; sum.gpuTrack += t.gpuTrack;
+                    sum.gpuDetect += t.gpuDetect;
+                    sum.gpuSelect += t.gpuSelect; sum.gpuDescribe += t.gpuDescribe; sum.gpuOverlay += t.gpuOverlay;
+                    sum.gpuTotal += t.gpuTotal;
+                    ++samples;
+                });
+                fillLatency(r, ms);
+                const double inv = 1.0 / double(samples);
+                r.stages = {sum.hostUpload * inv, sum.hostWait * inv, sum.hostReadback * inv, sum.gpuUpload * inv,
+                            sum.gpuPyramid * inv, sum.gpuTrack * inv, sum.gpuDetect * inv, sum.gpuSelect * inv, sum.gpuDescribe * inv,
+                            sum.gpuOverlay * inv, sum.gpuTotal * inv};
+
+                // Throughput with all frame slots busy
+                auto t0 = Clock::now();
+                for (int i = 0; i < iters; ++i) {
+                    if (gpu->inFlight() == gpu->framesInFlight()) {
+                        if (zeroCopy) gpu->collectInto(kps.data(), kps.size());
+                        else gpu->collect();
+                    }
+                    if (zeroCopy) gpu->submitImported(src);
+                    else gpu->submit(src);
+                }
+                while (gpu->inFlight() > 0) {
+                    if (zeroCopy) gpu->collectInto(kps.data(), kps.size());
+                    else gpu->collect();
+                }
+                r.streamFps = double(iters) / (msSince(t0) * 1e-3);
+                printRow(r);
+                results.push_back(r);
+            }
+
+            if (cpu) {
+                Result r = base;
+                r.backend = "cpu";
+                fillLatency(r, timeCalls(warmup, iters, [&] { r.keypoints = cpu->detect(img).size(); }));
+                printRow(r);
+                results.push_back(r);
+            }
+
+            if (runOpenCV) {
+                Result r = base;
+                r.backend = "opencv";
+                std::vector<cv::KeyPoint> kps;
+                cv::Mat desc;
+                // --orb: time cv::ORB detect + describe with the same levels and threshold instead
+                const cv::Ptr<cv::ORB> orb = cv::ORB::create(int(detOpts.maxKeypoints), detOpts.pyramidScale,
+                    int(detOpts.pyramidLevels), 31, 0, 2, cv::ORB::FAST_SCORE, 31, int(detOpts.threshold));
+                fillLatency(r, timeCalls(warmup, iters, [&] {
+                    if (detOpts.orb) orb->detectAndCompute(img, cv::Mat(), kps, desc);
+                    else cv::FAST(img, kps, int(detOpts.threshold), detOpts.nonmaxSuppression, cv::FastFeatureDetector::TYPE_9_16);
+                }));
+                r.keypoints = kps.size();
+                printRow(r);
+                results.push_back(r);
+            }
+        }
+    }
+
+    if (importBase) gpu->releaseHostBuffer(importBase);
+    if (!csv.empty()) writeCsv(csv, results);
+    return 0;
+}
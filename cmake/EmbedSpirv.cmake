@@ -0,0 +1,37 @@
+# Writes every ${SPV_DIR}/*.spv into ${OUT} as a uint32_t array plus a lookup
+# table ending in a null entry (see src/ShaderLibrary.cpp). Run as a script:
+#   cmake -DSPV_DIR=<dir> -DOUT=<header> -P EmbedSpirv.cmake
+file(GLOB spv_files "${SPV_DIR}/*.spv")
+list(SORT spv_files)
+
+set(body "")
+set(table "")
+foreach(spv ${spv_files})
+  get_filename_component(file_name ${spv} NAME)
+  string(MAKE_C_IDENTIFIER "spv_${file_name}" ident)
+  file(READ ${spv} hex HEX)
+  # SPIR-V is a stream of little-endian 32-bit words
+  string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1," words "${hex}")
+  # Eight words ("0x12345678," = 11 characters) per line; CMake regex has no {n}
+  string(LENGTH "${words}" len)
+  set(lines "")
+  foreach(pos RANGE 0 ${len} 88)
+    if(pos LESS len)
+      string(SUBSTRING "${words}" ${pos} 88 line)
+      string(APPEND lines "    ${line}\n")
+    endif()
+  endforeach()
+  string(APPEND body "static const uint32_t ${ident}[] = {\n${lines}};\n\n")
+  string(APPEND table "    {\"${file_name}\", ${ident}, sizeof(${ident})},\n")
+endforeach()
+
+set(content "// Generated by cmake/EmbedSpirv.cmake from ${SPV_DIR} - do not edit\n#pragma once\n#include <cstddef>\n#include <cstdint>\n\nnamespace embedded {\n\n${body}struct Shader {\n    const char* name;\n    const uint32_t* code;\n    size_t size;\n};\n\nstatic const Shader kShaders[] = {\n${table}    {nullptr, nullptr, 0},\n};\n\n} // namespace embedded\n")
+
+# Keep the timestamp when nothing changed so dependents are not rebuilt
+if(EXISTS ${OUT})
+  file(READ ${OUT} old)
+  if(old STREQUAL content)
+    return()
+  endif()
+endif()
+file(WRITE ${OUT} "${content}")
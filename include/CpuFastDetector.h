@@ -0,0 +1,62 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Detector.h"
+#include "ThreadPool.h"
+
+// CPU FAST backend with the semantics of the r8/r8ui shader variants: same
+// patterns, threshold, arc test, score, NMS, grid top-K and pyramid resampling.
+// Rows are split into strips that run on a thread pool; inside a strip the
+// segment test is vectorized (AVX2 where the CPU has it, else SSE2 on x86 and
+// NEON on ARM, chosen at run time) and only the detected corners are scored in
+// scalar code.
+namespace cpufast { struct Circle; }
+
+class CpuFastDetector : public Detector {
+public:
+    struct Options {
+        unsigned threads = 0;             // 0 = one per hardware thread
+        FastPattern pattern = FastPattern::Fast9_16;
+        uint32_t threshold = 76;          // intensity threshold in [0,255]
+        bool nonmaxSuppression = false;   // 3x3 NMS on the FAST score
+        uint32_t gridCell = 0;            // > 0: keep only the gridTopK best corners per
+        uint32_t gridTopK = 4;            //      gridCell x gridCell cell (level pixels)
+        uint32_t maxKeypoints = 1u << 16; // result capacity, shared by all images of a batch
+        uint32_t pyramidLevels = 1;       // 1 = full resolution only
+        float pyramidScale = 2.0f;        // size ratio between consecutive levels (> 1)
+        std::string simd;                 // segment test, one of simdPaths(); empty = the best
+    };
+
+    explicit CpuFastDetector(const Options& opts);
+
+    std::vector<Keypoint> detect(const cv::Mat& frame) override;
+    std::vector<std::vector<Keypoint>> detectBatch(const std::vector<cv::Mat>& frames) override;
+
+    float levelScale(uint32_t level) const override;
+    const char* name() const override { return "cpu"; }
+
+    // Same runtime tuning as FastDetector; thresholds above 255 are clamped
+    void setThreshold(uint32_t threshold);
+    void setPattern(FastPattern pattern) { opts_.pattern = pattern; }
+
+    // Segment tests this CPU can run, best first: "avx2", "sse2" or "neon", "scalar"
+    static std::vector<std::string> simdPaths();
+    const char* simd() const { return simd_; }
+    unsigned threads() const { return pool_.size(); }
+
+private:
+    void detectImage(const cv::Mat& frame, uint32_t layer, std::vector<Keypoint>& out);
+    void detectLevel(const cv::Mat& img, uint32_t layer, uint32_t level, std::vector<Keypoint>& out);
+    void downsample(const cv::Mat& src, cv::Mat& dst);
+
+    Options opts_;
+    const char* simd_ = "scalar";
+    int (*kernel_)(const uint8_t*, const cpufast::Circle&, int&, int, int*) = nullptr;   // cpufast::RowKernel
+    ThreadPool pool_;
+    cv::Mat gray_;                        // BGR -> gray conversion target
+    std::vector<cv::Mat> levels_;         // pyramid images, level 0 = input
+    std::vector<int32_t> scores_;         // reused score map for NMS/grid, -1 = no corner
+    bool overflowWarned_ = false;
+};
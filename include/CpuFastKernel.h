@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized segment test of CpuFastDetector, shared by the translation units
+// built for different instruction sets (CpuFastDetector.cpp: SSE2 / NEON
+// baseline, CpuFastAvx2.cpp: -mavx2, picked at run time). Only templates over
+// the SIMD type live here, so no inline function is compiled for two ISAs.
+// Simd provides reg, lanes, load/store/set1, adds/subs/sub, and_/or_, unsigned
+// gt (byte masks 0xFF / 0x00) and any.
+namespace cpufast {
+
+// Pattern, threshold and circle as byte offsets for one row stride
+struct Circle {
+    ptrdiff_t off[16];
+    int n;            // circle pixels
+    int arc;          // contiguous pixels needed
+    int step;         // distance between compass points
+    int compassMin;   // compass points any arc covers
+    int threshold;
+};
+
+// Writes the x of every pixel in [x, x1) that passes the segment test to xs,
+// left to right, and returns how many. Only whole vectors are tested; x is
+// advanced past them and the rest is left to the scalar test. The caller
+// guarantees the whole circle of every tested pixel is inside the image.
+using RowKernel = int (*)(const uint8_t* row, const Circle& c, int& x, int x1, int* xs);
+
+int segmentTestRowAvx2(const uint8_t* row, const Circle& c, int& x, int x1, int* xs);
+
+// Lanes whose c.n circle masks contain a wrap-around run of c.arc set bytes.
+// Runs are grown by doubling (1, 2, 4, ...) and then extended one step at a time.
+template <class Simd>
+typename Simd::reg arcMask(const typename Simd::reg* m, const Circle& c) {
+    using reg = typename Simd::reg;
+    const int n = c.n;
+    reg a[16], t[16];
+    for (int i = 0; i < n; ++i) a[i] = m[i];
+    int len = 1;
+    for (; len * 2 <= c.arc; len *= 2) {
+        for (int i = 0; i < n; ++i) t[i] = Simd::and_(a[i], a[(i + len) % n]);
+        for (int i = 0; i < n; ++i) a[i] = t[i];
+    }
+    for (; len < c.arc; ++len) {
+        for (int i = 0; i < n; ++i) a[i] = Simd::and_(a[i], m[(i + len) % n]);
+    }
+    reg any = a[0];
+    for (int i = 1; i < n; ++i) any = Simd::or_(any, a[i]);
+    return any;
+}
+
+template <class Simd>
+int segmentTestRow(const uint8_t* row, const Circle& c, int& x, int x1, int* xs) {
+    using reg = typename Simd::reg;
+    int count = 0;
+    // v > I0 + t  <=>  v > sat(I0 + t), and v < I0 - t  <=>  v < sat(I0 - t):
+    // saturation makes the out-of-range cases false, exactly like the int compare
+    const reg t = Simd::set1(uint8_t(c.threshold));
+    const reg compassMin = Simd::set1(uint8_t(c.compassMin - 1));
+    for (; x + Simd::lanes <= x1; x += Simd::lanes) {
+        const uint8_t* p = row + x;
+        const reg center = Simd::load(p);
+        const reg hi = Simd::adds(center, t);
+        const reg lo = Simd::subs(center, t);
+
+        // High-speed test on the compass points for all lanes at once
+        reg b[16], d[16];
+        reg nb = Simd::set1(0), nd = Simd::set1(0);
+        for (int i = 0; i < c.n; i += c.step) {
+            const reg v = Simd::load(p + c.off[i]);
+            b[i] = Simd::gt(v, hi);
+            d[i] = Simd::gt(lo, v);
+            nb = Simd::sub(nb, b[i]);   // mask bytes are -1
+            nd = Simd::sub(nd, d[i]);
+        }
+        if (!Simd::any(Simd::or_(Simd::gt(nb, compassMin), Simd::gt(nd, compassMin)))) continue;
+
+        for (int i = 0; i < c.n; ++i) {
+            if (i % c.step == 0) continue;
+            const reg v = Simd::load(p + c.off[i]);
+            b[i] = Simd::gt(v, hi);
+            d[i] = Simd::gt(lo, v);
+        }
+        const reg corner = Simd::or_(arcMask<Simd>(b, c), arcMask<Simd>(d, c));
+        if (!Simd::any(corner)) continue;
+
+        alignas(32) uint8_t lane[Simd::lanes];
+        Simd::store(lane, corner);
+        for (int j = 0; j < Simd::lanes; ++j) {
+            if (lane[j]) xs[count++] = x + j;
+        }
+    }
+    return count;
+}
+
+} // namespace cpufast
@@ -0,0 +1,52 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <vector>
+#include <cstdint>
+
+// Must match struct Keypoint / KeypointBuffer in shaders/*.comp.glsl
+struct Keypoint {
+    uint32_t x;
+    uint32_t y;
+    float    score;
+    uint32_t layer;    // index of the image within its batch (0 for single frames)
+    uint32_t level;    // pyramid level (like cv::KeyPoint::octave); x/y are in that level's
+                       // pixels, multiply by Detector::levelScale(level) for full resolution
+};
+
+// Segment-test patterns of both backends (as cv::FastFeatureDetector::DetectorType):
+// an arc of `arc` contiguous pixels out of `circle` on a Bresenham circle of `radius`
+enum class FastPattern { Fast9_16, Fast7_12, Fast5_8 };
+
+struct FastPatternInfo {
+    uint32_t circle;
+    uint32_t arc;
+    uint32_t radius;
+};
+
+inline FastPatternInfo fastPatternInfo(FastPattern p) {
+    switch (p) {
+    case FastPattern::Fast7_12: return {12, 7, 2};
+    case FastPattern::Fast5_8:  return {8, 5, 1};
+    default:                    return {16, 9, 3};
+    }
+}
+
+// Pixels closer than this to the image edge are never corners (any pattern, as cv::FAST)
+constexpr uint32_t kFastBorder = 3;
+
+// Common interface of the FAST backends: FastDetector (Vulkan) and
+// CpuFastDetector. Both implement the same segment test, score, NMS, grid and
+// pyramid rules, so they return the same keypoints; only the order may differ.
+class Detector {
+public:
+    virtual ~Detector() = default;
+
+    // 8-bit grayscale (or BGR) frame in, keypoints out
+    virtual std::vector<Keypoint> detect(const cv::Mat& frame) = 0;
+    // Same-size frames in, one keypoint list per frame out
+    virtual std::vector<std::vector<Keypoint>> detectBatch(const std::vector<cv::Mat>& frames) = 0;
+
+    // Factor from level-`level` pixel coordinates to full resolution
+    virtual float levelScale(uint32_t level) const = 0;
+    virtual const char* name() const = 0;
+};
@@ -0,0 +1,449 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <opencv2/core.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <map>
+#include <tuple>
+#include "VulkanSetup.h"
+#include "PipelineCache.h"
+#include "MemoryAllocator.h"
+#include "Detector.h"
+#include "Telemetry.h"
+
+// FAST corner detector on top of VulkanSetup. Pipelines are built once; images,
+// staging and readback memory are created per resolution and reused, and the
+// whole upload -> detect -> (nms) -> (overlay) sequence is prerecorded into one
+// command buffer per frame slot.
+//
+// Streaming: with Options::framesInFlight = N there are N slots, each with its own
+// images, staging/keypoint buffers, command buffer and fence, so the host can fill
+// frame k+1 while the GPU works on frame k and frame k-1 is being read back:
+//
+//     for (auto& f : frames) {
+//         if (det.inFlight() == det.framesInFlight()) use(det.collect());
+//         det.submit(f);
+//     }
+//     while (det.inFlight() > 0) use(det.collect());
+//
+// Batches: submitBatch()/detectBatch() pack same-size frames into the layers of
+// one 2D array image and run every stage with a single z-dispatch, which
+// amortizes submission and dispatch overhead for small frames.
+//
+// Pyramid: with Options::pyramidLevels > 1 the input is downsampled on the GPU,
+// level by level, in the same command buffer, and FAST runs on every level.
+//
+// ORB: with Options::orb the final keypoint list also gets an orientation and a
+// 256-bit steered BRIEF descriptor, computed on the levels still on the device
+// (see descriptors()).
+//
+// Tracking: with Options::maxTrackPoints > 0, points of the previously submitted
+// frame passed to trackPoints() are followed into the next submitted frame by a
+// pyramidal Lucas-Kanade pass on the pyramids both slots already hold, recorded
+// into the same command buffer ahead of FAST (see trackedPoints()). The ring gets
+// one extra slot so the previous frame's images stay intact while it is read.
+//
+// Tile mask: with Options::tileMask, FAST only runs on the workgroup tiles that
+// setDetectionMask() / setDetectionTiles() leave enabled (a fixed hood mask, areas
+// already covered by tracks). A small pass compacts them into a list per level,
+// and FAST is launched with vkCmdDispatchIndirect over just those tiles.
+//
+// Queues: with VulkanSetup::Options::dedicatedQueues the upload runs on the
+// transfer-only queue (the DMA engine of discrete GPUs), so it overlaps the
+// previous slot's compute work; the level-0 image is handed to the compute
+// family with a queue family ownership transfer and a semaphore per slot.
+// Options::asyncCompute moves detection to the compute-only queue.
+//
+// Telemetry: with Options::telemetry every collected frame updates counters and
+// latency histograms (per-stage GPU time, queue wait, keypoints, ring occupancy,
+// device memory) in a caller-owned registry that other threads can scrape(), and
+// adds host and GPU spans to its trace when that is enabled.
+//
+// Zero-copy: submitImported() lets the GPU read caller-owned pixels through
+// VK_EXT_external_memory_host, stagingFrame()/submitStaged() let the caller write
+// straight into a slot's staging memory, and collectInto()/overlayRGBA() hand out
+// results without intermediate vectors or conversions. submit() stays the
+// fallback for everything these cannot take.
+class FastDetector : public Detector {
+public:
+    enum class InputFormat {
+        R8UInt,   // grayscale bytes as-is, integer comparisons
+        R8UNorm,  // grayscale bytes as unorm, rescaled to integers in the shader
+        RGBA8     // gray expanded to RGBA on the host, float luminance
+    };
+
+    struct Options {
+        InputFormat inputFormat = InputFormat::R8UInt;
+        bool tiled = false;               // shared-memory tiled kernel
+        uint32_t workgroupX = 16;         // FAST workgroup size (specialization constants 0/1)
+        uint32_t workgroupY = 16;
+        FastPattern pattern = FastPattern::Fast9_16;  // specialization constants 3/4
+        uint32_t threshold = 76;          // intensity threshold in [0,255] (push constant)
+        bool nonmaxSuppression = false;   // GPU 3x3 NMS on the FAST score
+        uint32_t gridCell = 0;            // > 0: keep only the gridTopK best corners per
+        uint32_t gridTopK = 4;            //      gridCell x gridCell cell (level pixels)
+        uint32_t maxKeypoints = 1u << 16; // keypoint buffer capacity, shared by all images of a batch
+        bool tileMask = false;            // FAST only on tiles enabled by setDetectionMask(), indirect dispatch
+        bool debugOverlay = false;        // also render + read back an RGBA overlay image
+        bool orb = false;                 // ORB orientation + rBRIEF descriptor per keypoint
+        uint32_t maxTrackPoints = 0;      // > 0: KLT capacity per frame, see trackPoints()
+        uint32_t trackWindow = 21;        // KLT window edge in pixels (odd, 3..31)
+        uint32_t trackIterations = 30;    // per level
+        float trackEpsilon = 0.01f;       // stop a level once the update is shorter (pixels)
+        float trackMinEigen = 1e-4f;      // lost below this gradient-matrix eigenvalue per window
+                                          // pixel, intensities in [0,1]
+        uint32_t framesInFlight = 1;      // number of ring slots for submit()/collect()
+        uint32_t pyramidLevels = 1;       // 1 = full resolution only
+        float pyramidScale = 2.0f;        // size ratio between consecutive levels (> 1)
+        bool profile = false;             // per-stage host timers + GPU timestamps, see timings()
+        Telemetry* telemetry = nullptr;   // metrics + trace per collected frame, implies profile;
+                                          // must outlive the detector
+        bool transferQueue = true;        // upload on VulkanSetup::transferQueue() if it is a separate family
+        bool asyncCompute = false;        // detect on VulkanSetup::asyncComputeQueue()
+        std::string shaderDir;            // directory with *.spv files; empty = embedded / build tree
+        std::string pipelineCache;        // VkPipelineCache file, reused across runs; empty = none
+    };
+
+    // Per-stage latency of the last collected frame in milliseconds (Options::profile).
+    // gpu* come from vkCmdWriteTimestamp and stay 0 if the queue has no timestamps.
+    struct Timings {
+        double hostUpload = 0;    // submit(): gray/RGBA conversion + staging memcpy
+        double hostWait = 0;      // collect(): fence wait
+        double hostReadback = 0;  // collect(): keypoint copy out of mapped memory
+        double gpuUpload = 0;     // vkCmdCopyBufferToImage (transfer queue: wait + ownership acquire)
+        double gpuPyramid = 0;    // pyramid levels + keypoint counter reset
+        double gpuTrack = 0;      // KLT on all levels
+        double gpuDetect = 0;     // FAST on all levels, tile lists included (tileMask)
+        double gpuSelect = 0;     // NMS or grid top-K
+        double gpuDescribe = 0;   // ORB smoothing, orientation and descriptors
+        double gpuOverlay = 0;    // debug overlay and its readback copy
+        double gpuTotal = 0;
+    };
+
+    // One entry per point given to trackPoints(), same order
+    struct Track {
+        float x = 0, y = 0;       // position in the new frame, level-0 pixels
+        bool found = false;       // false: left the image, too little texture, or no previous frame
+        float error = 0;          // mean absolute difference over the window, gray levels
+    };
+
+    FastDetector(const VulkanSetup& vk, const Options& opts);
+    ~FastDetector() override;
+
+    FastDetector(const FastDetector&) = delete;
+    FastDetector& operator=(const FastDetector&) = delete;
+
+    // Detects corners in an 8-bit grayscale (or BGR) frame and waits for the result.
+    // Resources are only recreated when the frame size changes. Requires inFlight() == 0.
+    std::vector<Keypoint> detect(const cv::Mat& frame) override;
+
+    // Copies the frame into the next free slot and submits it without waiting.
+    // Throws if all slots are in flight - collect() one first.
+    void submit(const cv::Mat& frame);
+    // Waits for the oldest submitted frame and returns its keypoints (FIFO order).
+    // For a batch this is the keypoints of all images, tagged with Keypoint::layer.
+    std::vector<Keypoint> collect();
+
+    // Zero-copy variant of submit() for 8-bit grayscale frames with a single-channel
+    // input format. The frame memory is imported and copied to the image on the GPU,
+    // so frame.data must be aligned to importAlignment() and the caller must own the
+    // range up to data + the image size rounded up to importAlignment(). The pixels
+    // must stay unchanged until this frame is collected.
+    // A frame starting at a registerHostBuffer() address uses that buffer's import.
+    // Any other frame is imported for this submission only and released when it is
+    // collected, so its memory may be freed after collect() (per-frame imports are
+    // slow; register the buffers of a capture ring instead).
+    // Anything else (no extension, RGBA8, misaligned, failed import) goes through
+    // submit() with a one-time warning.
+    void submitImported(const cv::Mat& frame);
+
+    // Imports [data, data + bytes rounded up to importAlignment()) once for
+    // submitImported(). The memory must stay allocated until releaseHostBuffer()
+    // (or the detector is destroyed); registering the same address again replaces
+    // the import. Returns false if it cannot be imported.
+    bool registerHostBuffer(const void* data, size_t bytes);
+    // Drops the import of a registered buffer; no frame using it may be in flight
+    void releaseHostBuffer(const void* data);
+    size_t importAlignment() const { return size_t(vk_.hostImportAlignment()); }   // 0 = unsupported
+
+    // Staging in place: a width x height CV_8UC1 view of the next free slot's staging
+    // memory (single-channel input formats only). Write the frame into it, then call
+    // submitStaged(); any other submit in between discards it.
+    cv::Mat stagingFrame(uint32_t width, uint32_t height);
+    void submitStaged();
+
+    // collect() into caller memory: copies up to `capacity` keypoints of the oldest
+    // frame straight out of mapped memory and returns how many were found
+    size_t collectInto(Keypoint* out, size_t capacity);
+
+    // Batched variants: all frames must have the same size and type; the result
+    // holds one keypoint list per input frame. A batch occupies one slot.
+    std::vector<std::vector<Keypoint>> detectBatch(const std::vector<cv::Mat>& frames) override;
+    void submitBatch(const std::vector<cv::Mat>& frames);
+    std::vector<std::vector<Keypoint>> collectBatch();
+
+    float levelScale(uint32_t level) const override;
+    const char* name() const override { return "vulkan"; }
+
+    uint32_t inFlight() const { return inFlight_; }
+    uint32_t framesInFlight() const { return opts_.framesInFlight; }
+
+    // BGR overlay of the last collected frame, or of image `layer` of the last
+    // collected batch (requires Options::debugOverlay).
+    // Only valid until the next submit() reuses that slot.
+    cv::Mat overlayImage(uint32_t layer = 0) const;
+    void overlayImage(cv::Mat& bgr, uint32_t layer = 0) const;   // reuses the caller's buffer
+    cv::Mat overlayRGBA(uint32_t layer = 0) const;               // view of the mapped readback, no copy
+
+    // ORB features of the last collected frame or batch (requires Options::orb),
+    // row i belonging to keypoint i of collect(): descriptors() is N x 32 CV_8U in
+    // cv::ORB::compute() layout, so it matches against OpenCV ORB descriptors;
+    // angles() are degrees in [0, 360) as cv::KeyPoint::angle.
+    cv::Mat descriptors() const;
+    std::vector<float> angles() const;
+
+    // KLT (requires Options::maxTrackPoints): positions in the previously submitted
+    // frame to follow into the frame of the next submit(), as prevPts of
+    // cv::calcOpticalFlowPyrLK. Window, levels and pyramidScale are the detector's.
+    // Only single-image submits of the same size as the previous one are tracked;
+    // otherwise every point comes back with found = false.
+    void trackPoints(const std::vector<cv::Point2f>& prevPts);
+    // Tracks of the last collected frame (empty if it had no trackPoints())
+    std::vector<Track> trackedPoints() const;
+
+    // Tile-sparse detection (requires Options::tileMask), effective from the next
+    // submit() and applied to every image of a batch. Tiles are FAST workgroups
+    // (workgroupX x workgroupY pixels of a level); a level's tile is searched when
+    // any level-0 tile under it is enabled. The mask is only applied per tile, so
+    // corners close to its edge survive inside an enabled tile.
+    // mask: frame-sized CV_8UC1, nonzero = detect; empty = the whole frame
+    void setDetectionMask(const cv::Mat& mask);
+    // The level-0 tile grid directly, detectionTileGrid() cells of CV_8UC1, e.g.
+    // a tracker clearing the tiles its tracks already cover
+    void setDetectionTiles(const cv::Mat& tiles);
+    cv::Size detectionTileGrid(uint32_t width, uint32_t height) const;
+
+    // Runtime tuning, effective from the next submit(). The threshold is a push
+    // constant: only the slot's command buffer is re-recorded, so it can change
+    // every frame (values above 255 are clamped). A new pattern / workgroup size
+    // builds its pipeline variant once; variants are cached for switching back.
+    void setThreshold(uint32_t threshold);
+    void setPattern(FastPattern pattern);
+    void setWorkgroupSize(uint32_t x, uint32_t y);
+
+    // Device memory of all slots (blocks, live sub-allocations, reuse count)
+    MemoryAllocator::Stats memoryStats() const { return allocator_.stats(); }
+
+    const Timings& timings() const { return timings_; }
+    bool hasGpuTimestamps() const { return timestampPeriod_ > 0.0; }
+
+    // Effective input format (RGBA8 if the device lacks R8 storage images)
+    InputFormat inputFormat() const { return inputFormat_; }
+    const Options& options() const { return opts_; }
+
+private:
+    struct Image {
+        VkImage image = VK_NULL_HANDLE;
+        MemoryAllocator::Allocation memory;
+        VkImageView view = VK_NULL_HANDLE;
+    };
+    struct Buffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        MemoryAllocator::Allocation memory;
+        VkDeviceSize size = 0;
+        void* mapped = nullptr;           // persistently mapped if host visible
+    };
+    struct Pipeline {
+        VkShaderModule module = VK_NULL_HANDLE;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+    };
+
+    // One pyramid level of a frame slot; level 0 is the uploaded input
+    struct Level {
+        uint32_t width = 0, height = 0;
+        Image image, score;
+        VkDescriptorSet fastSet = VK_NULL_HANDLE;
+        VkDescriptorSet nmsSet = VK_NULL_HANDLE;  // also used by the grid pass (same layout)
+        VkDescriptorSet pyrSet = VK_NULL_HANDLE;  // level-1 -> level (unused on level 0)
+        Image smooth;                             // Options::orb: blurred level, r32f
+        VkDescriptorSet blurSet = VK_NULL_HANDLE;
+        VkDescriptorSet orbSet = VK_NULL_HANDLE;
+        VkDescriptorSet trackSet = VK_NULL_HANDLE;  // previous slot's level -> this level
+        VkDescriptorSet tileSet = VK_NULL_HANDLE;   // Options::tileMask: mask -> this level's tile list
+        uint32_t tilesX = 0, tilesY = 0;            // workgroup tiles of the level
+        VkDeviceSize tileOffset = 0;                // this level's {dispatch, list} in Frame::tiles
+    };
+
+    // Where level 0 is copied from: the slot's staging buffer or an imported
+    // caller buffer (rowLength in texels, 0 = tightly packed)
+    struct UploadSource {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        uint32_t rowLength = 0;
+        bool operator==(const UploadSource& o) const { return buffer == o.buffer && rowLength == o.rowLength; }
+    };
+
+    // Caller memory imported with VK_EXT_external_memory_host
+    struct HostImport {
+        const void* base = nullptr;
+        VkDeviceSize size = 0;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+    };
+
+    // One ring slot: everything a frame touches between submit() and collect()
+    struct Frame {
+        uint32_t width = 0, height = 0, layers = 0;
+        std::vector<Level> levels;        // Options::pyramidLevels entries
+        uint32_t levelCount = 0;          // levels actually in use for this size
+        Image overlay;
+        Buffer staging, readback;
+        Buffer keypoints;                 // uint count + Keypoint[maxKeypoints]
+        Buffer descriptors, angles;       // Options::orb: 32 bytes / one float per keypoint
+        Buffer track;                     // Options::maxTrackPoints: uint count + TrackSlot[]
+        uint32_t trackCount = 0;          // points of this submission
+        Buffer tiles;                     // Options::tileMask: level-0 tile mask, then per level
+                                          // VkDispatchIndirectCommand + active tile list
+        uint32_t gridX = 0, gridY = 0;    // level-0 tile grid, workgroups of gridWorkgroup*
+        uint32_t gridWorkgroupX = 0, gridWorkgroupY = 0;
+        uint64_t maskVersion = 0;         // setDetectionMask() state in the mask region
+        uint64_t generation = 0;          // changes whenever the images are recreated
+        bool hasFrame = false;            // the images hold a submitted frame
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkCommandBuffer uploadCmd = VK_NULL_HANDLE;   // transfer queue only
+        VkSemaphore uploaded = VK_NULL_HANDLE;        // uploadCmd -> cmd
+        VkDescriptorSet overlaySet = VK_NULL_HANDLE;
+        VkQueryPool queries = VK_NULL_HANDLE;  // kStampCount timestamps (Options::profile)
+        double hostUploadMs = 0;
+        Telemetry::Clock::time_point submitTime, waitStart;   // Options::telemetry
+        uint64_t sequence = 0;            // submission number, the trace's frame argument
+        UploadSource upload;              // source of the next / current submission
+        HostImport hostImport;            // unregistered submitImported() frame, dropped on collect
+        // State baked into cmd; re-recorded on submit when it differs
+        VkPipeline recordedFast = VK_NULL_HANDLE;
+        uint32_t recordedThreshold = 0;
+        UploadSource recordedUpload;
+        uint64_t recordedTrackSource = 0; // generation of the slot bound as previous frame
+    };
+
+    // Timestamp slots written by recordCommands(), stage k lasts from stamp k-1 to k
+    enum Stamp : uint32_t { kStampBegin, kStampUpload, kStampPyramid, kStampTrack, kStampDetect, kStampSelect, kStampDescribe, kStampEnd, kStampCount };
+
+    // Options::telemetry handles, registered once; detectors sharing a registry add up
+    struct Metrics {
+        Telemetry::Counter* frames = nullptr;
+        Telemetry::Counter* keypoints = nullptr;
+        Telemetry::Counter* overflows = nullptr;
+        Telemetry::Counter* rebuilds = nullptr;
+        Telemetry::Histogram* keypointsPerFrame = nullptr;
+        Telemetry::Histogram* ringOccupancy = nullptr;    // slots in flight after each submit
+        Telemetry::Histogram* host[3] = {};               // upload, queue wait, readback
+        Telemetry::Histogram* gpu[kStampCount] = {};      // stage ending at stamp k; [kStampBegin] = total
+        Telemetry::Gauge* inFlight = nullptr;
+        Telemetry::Gauge* heldBytes = nullptr;
+        Telemetry::Gauge* liveBytes = nullptr;
+        Telemetry::Gauge* liveAllocations = nullptr;
+    };
+
+    // FAST writes a dense score image for a later selection pass (NMS or grid)
+    bool writeScores() const { return opts_.nonmaxSuppression || opts_.gridCell > 0; }
+    // Ring size: tracking keeps one more slot than may be in flight
+    uint32_t slotCount() const { return opts_.framesInFlight + (opts_.maxTrackPoints > 0 ? 1 : 0); }
+
+    void chooseInputFormat();
+    void createDescriptors();
+    void createPipelines();
+    void checkWorkgroup(uint32_t x, uint32_t y) const;
+    void selectFastPipeline();
+    void createFrame(Frame& f);
+    void destroyFrame(Frame& f);
+    void createResources(Frame& f, uint32_t width, uint32_t height, uint32_t layers);
+    void destroyResources(Frame& f);
+    void writeDescriptors(Frame& f);
+    void writeTrackDescriptors(Frame& f, const Frame& prev);
+    void prepareTracking(Frame& f);
+    void writeTileMask(Frame& f);
+    void recordCommands(Frame& f);
+    Frame& acquireSlot(uint32_t width, uint32_t height, uint32_t layers);
+    void submitSlot(Frame& f, const UploadSource& upload);
+    Frame& waitOldest();
+    void uploadFrame(Frame& f, const cv::Mat& frame, uint32_t layer);
+    bool importHostMemory(const void* base, VkDeviceSize size, HostImport& imp);
+    void destroyImport(HostImport& imp);
+    uint32_t keypointCount(const Frame& f) const;
+    const Keypoint* keypointList(const Frame& f) const;
+    std::vector<Keypoint> readKeypoints(const Frame& f) const;
+    void readTimestamps(const Frame& f);
+    void registerMetrics();
+    void reportTelemetry(const Frame& f, uint32_t keypoints, Telemetry::Clock::time_point readStart);
+
+    void createImage(Image& img, VkFormat format, uint32_t width, uint32_t height, uint32_t layers = 1);
+    void destroyImage(Image& img);
+    void createBuffer(Buffer& buf, VkDeviceSize size, VkBufferUsageFlags usage,
+                      VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferred = 0);
+    void destroyBuffer(Buffer& buf);
+    void createPipeline(Pipeline& p, const std::string& spvName, VkDescriptorSetLayout setLayout,
+                        uint32_t pushConstantSize, const VkSpecializationInfo* spec);
+    void destroyPipeline(Pipeline& p);
+    VkCommandBuffer beginOneShot();
+    void endOneShot(VkCommandBuffer cmd);
+
+private:
+    const VulkanSetup& vk_;
+    Options opts_;
+    InputFormat inputFormat_ = InputFormat::R8UInt;
+    VkFormat format_ = VK_FORMAT_R8_UINT;
+    uint32_t bytesPerPixel_ = 1;
+    std::string shaderSuffix_;
+    uint32_t maxLayers_ = 1;              // VkPhysicalDeviceLimits::maxImageArrayLayers
+    double timestampPeriod_ = 0.0;        // ns per tick, 0 = no timestamps on the queue
+    uint64_t timestampMask_ = 0;          // timestampValidBits of the queue family
+    Timings timings_;
+    uint64_t stampTicks_[kStampCount] = {};   // raw timestamps of the last collected frame
+    Metrics metrics_;
+    int64_t gpuClockOffsetNs_ = INT64_MIN;    // host - GPU ns, running lower bound (trace only)
+    uint64_t submitted_ = 0;
+
+    // Shared by all slots
+    MemoryAllocator allocator_;
+    VkQueue queue_ = VK_NULL_HANDLE;      // compute work
+    uint32_t queueFamily_ = 0;
+    VkQueue transferQueue_ = VK_NULL_HANDLE;   // set only if it is a separate family
+    uint32_t transferFamily_ = 0;
+    VkCommandPool cmdPool_ = VK_NULL_HANDLE;
+    VkCommandPool transferPool_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout fastDsl_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout nmsDsl_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout overlayDsl_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout pyrDsl_ = VK_NULL_HANDLE;   // also the blur pass (image -> image)
+    VkDescriptorSetLayout orbDsl_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout trackDsl_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout tileDsl_ = VK_NULL_HANDLE;
+    VkDescriptorPool descPool_ = VK_NULL_HANDLE;
+    Pipeline nmsPipe_, overlayPipe_, pyrPipe_, gridPipe_, blurPipe_, orbPipe_, trackPipe_, tilePipe_;
+    // FAST variants by (pattern, workgroupX, workgroupY); fastPipe_ is the current one
+    std::map<std::tuple<FastPattern, uint32_t, uint32_t>, Pipeline> fastVariants_;
+    const Pipeline* fastPipe_ = nullptr;
+    std::unique_ptr<PipelineCache> pipelineCache_;
+    cv::Mat hostScratch_;                 // reused conversion target (BGR->gray, gray->RGBA)
+    std::vector<HostImport> imports_;     // registerHostBuffer()
+    PFN_vkGetMemoryHostPointerPropertiesEXT getHostPointerProperties_ = nullptr;
+    bool importWarned_ = false;
+    mutable bool overflowWarned_ = false;     // keypointCount() runs from const readers
+    bool staged_ = false;                 // stagingFrame() handed out frames_[next_]
+    std::vector<cv::Point2f> pendingTrack_;   // trackPoints() for the next submit
+    uint64_t generation_ = 0;
+    cv::Mat detectionMask_, detectionTiles_;  // at most one set; both empty = every tile
+    uint64_t maskVersion_ = 1;
+    VkDeviceSize storageAlignment_ = 4;   // minStorageBufferOffsetAlignment
+
+    // Ring of frame slots: [next_ - inFlight_, next_) are submitted, oldest first;
+    // at most Options::framesInFlight of the slotCount() slots are in flight
+    std::vector<Frame> frames_;
+    uint32_t next_ = 0;
+    uint32_t inFlight_ = 0;
+    int lastCollected_ = -1;
+};
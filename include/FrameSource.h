@@ -0,0 +1,126 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+#include <deque>
+#include <future>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include "ThreadPool.h"
+#include "MappedFile.h"
+
+// Frame input for the streaming loop, in order and as 8-bit grayscale. Two kinds:
+//
+//   ImageSequence  image files decoded ahead of use on a thread pool, so decoding
+//                  overlaps the GPU work on the frames before
+//   Y8Sequence     raw frames in a memory-mapped .y8 file (Y8Writer), handed out
+//                  as views into the mapping - no decode, no copy before staging
+//
+//     auto src = FrameSource::open(path);
+//     for (cv::Mat f = src->next(); !f.empty(); f = src->next()) det.submit(f);
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    virtual size_t frameCount() const = 0;
+    // Next frame, empty once the sequence is exhausted. Valid until the next call
+    // (Y8Sequence views stay valid as long as the source).
+    virtual cv::Mat next() = 0;
+
+    // path: a .y8 file, a directory of images (sorted by name), a .txt list with
+    // one image path per line, or a single image. threads = 0: one decoder per
+    // hardware thread; prefetch = 0: twice the decoder count.
+    static std::unique_ptr<FrameSource> open(const std::string& path, unsigned threads = 0, unsigned prefetch = 0);
+};
+
+// Decodes cv::imread(IMREAD_GRAYSCALE) on a pool, keeping up to `prefetch` frames
+// decoded or in progress beyond the one last returned
+class ImageSequence : public FrameSource {
+public:
+    ImageSequence(std::vector<std::string> paths, unsigned threads = 0, unsigned prefetch = 0);
+    ~ImageSequence() override;
+
+    size_t frameCount() const override { return paths_.size(); }
+    cv::Mat next() override;   // throws if a file cannot be decoded
+
+private:
+    void schedule();
+
+    std::vector<std::string> paths_;
+    ThreadPool pool_;
+    size_t prefetch_;
+    size_t scheduled_ = 0;                // paths_[0, scheduled_) were handed to the pool
+    std::deque<std::future<cv::Mat>> pending_;
+};
+
+// .y8: raw 8-bit grayscale frames of one size with a frame index. Little-endian:
+//
+//   Header (48 bytes)   magic "FASTY8\0\0", version, width, height, stride,
+//                       alignment, reserved, frameCount, indexOffset
+//   frames              stride * height bytes each, at multiples of `alignment`
+//                       (the page size, so every frame is page-aligned when mapped)
+//   index               frameCount x {uint64 offset, int64 timestampNs (-1 = none)},
+//                       at a multiple of 8
+struct Y8Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;          // bytes per row, >= width
+    uint32_t alignment;
+    uint32_t reserved;        // explicit padding
+    uint64_t frameCount;
+    uint64_t indexOffset;
+};
+
+struct Y8IndexEntry {
+    uint64_t offset;
+    int64_t timestampNs;
+};
+
+class Y8Sequence : public FrameSource {
+public:
+    // prefetch: frames ahead of the current one the kernel is asked to read in
+    explicit Y8Sequence(const std::string& path, unsigned prefetch = 4);
+
+    size_t frameCount() const override { return size_t(header_.frameCount); }
+    cv::Mat next() override;
+
+    // Random access; views into the read-only mapping, do not write to them
+    cv::Mat frame(size_t i) const;
+    int64_t timestampNs(size_t i) const { return index_[i].timestampNs; }
+    uint32_t width() const { return header_.width; }
+    uint32_t height() const { return header_.height; }
+
+private:
+    void advise(size_t first, size_t count) const;
+
+    MappedFile file_;
+    Y8Header header_{};
+    const Y8IndexEntry* index_ = nullptr;
+    unsigned prefetch_;
+    size_t next_ = 0;
+};
+
+// Writes a .y8 file frame by frame; the index and final header go out in close()
+class Y8Writer {
+public:
+    Y8Writer(const std::string& path, uint32_t width, uint32_t height);
+    ~Y8Writer();   // close()
+
+    Y8Writer(const Y8Writer&) = delete;
+    Y8Writer& operator=(const Y8Writer&) = delete;
+
+    // frame: CV_8UC1 of the file's size (BGR is converted)
+    void append(const cv::Mat& frame, int64_t timestampNs = -1);
+    void close();
+    size_t frameCount() const { return index_.size(); }
+
+private:
+    std::string path_;
+    std::ofstream out_;
+    Y8Header header_{};
+    std::vector<Y8IndexEntry> index_;
+    cv::Mat gray_;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+#include <deque>
+#include <future>
+#include <fstream>
+#include <cstdint>
+#include "Detector.h"
+#include "ThreadPool.h"
+#include "MappedFile.h"
+
+// .kps: keypoint lists of a frame sequence, written while detection runs and
+// read back through a memory mapping. Little-endian, 8-byte aligned blocks:
+//
+//   Header (40 bytes)   magic "FASTKP\0\0", version, recordBytes (sizeof(Keypoint)),
+//                       descriptorBytes (0 = none, 32 = ORB), reserved,
+//                       frameCount, indexOffset
+//   per frame           count Keypoint records as in Detector.h, then
+//                       count x descriptorBytes descriptor rows
+//   index               frameCount x {uint64 offset, uint32 count, uint32 reserved,
+//                       int64 timestampNs (-1 = none)}
+//
+// Like .y8 the index goes last, so an unclosed file is rejected rather than misread.
+struct KpsHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordBytes;
+    uint32_t descriptorBytes;
+    uint32_t reserved;        // explicit padding
+    uint64_t frameCount;
+    uint64_t indexOffset;
+};
+
+struct KpsIndexEntry {
+    uint64_t offset;
+    uint32_t count;
+    uint32_t reserved;
+    int64_t timestampNs;
+};
+
+// Appends frames on a background thread; append() only queues and blocks when
+// `maxPending` frames are still waiting for the disk
+class KeypointWriter {
+public:
+    // descriptorBytes: 0, or the row size of the descriptors given to append()
+    KeypointWriter(const std::string& path, uint32_t descriptorBytes = 0, size_t maxPending = 64);
+    ~KeypointWriter();   // close(), errors are dropped
+
+    KeypointWriter(const KeypointWriter&) = delete;
+    KeypointWriter& operator=(const KeypointWriter&) = delete;
+
+    // descriptors: keypoints.size() x descriptorBytes CV_8U (copied), ignored if descriptorBytes is 0
+    void append(std::vector<Keypoint> keypoints, const cv::Mat& descriptors = cv::Mat(), int64_t timestampNs = -1);
+    // Waits for the queue, writes index and header; rethrows the first write error
+    void close();
+    size_t frameCount() const { return appended_; }
+
+private:
+    void write(const std::vector<Keypoint>& keypoints, const cv::Mat& descriptors, int64_t timestampNs);
+    void waitOldest();
+
+    std::string path_;
+    std::ofstream out_;               // only touched by the writer thread until close()
+    KpsHeader header_{};
+    std::vector<KpsIndexEntry> index_;
+    ThreadPool worker_{1};            // one worker keeps the frames in order
+    size_t maxPending_;
+    std::deque<std::future<void>> pending_;
+    size_t appended_ = 0;
+    bool closed_ = false;
+};
+
+// Random access to a closed .kps file; everything returned points into the mapping
+class KeypointReader {
+public:
+    explicit KeypointReader(const std::string& path);
+
+    size_t frameCount() const { return size_t(header_.frameCount); }
+    uint32_t descriptorBytes() const { return header_.descriptorBytes; }
+
+    size_t count(size_t frame) const { return entry(frame).count; }
+    const Keypoint* keypoints(size_t frame) const;
+    // count(frame) x descriptorBytes() CV_8U view, empty without descriptors; read only
+    cv::Mat descriptors(size_t frame) const;
+    int64_t timestampNs(size_t frame) const { return entry(frame).timestampNs; }
+
+private:
+    const KpsIndexEntry& entry(size_t frame) const;
+
+    MappedFile file_;
+    KpsHeader header_{};
+    const KpsIndexEntry* index_ = nullptr;
+};
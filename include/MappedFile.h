@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Read-only mapping of a whole file (POSIX, header-only), shared by the .y8 and
+// .kps readers. The pages are loaded on first touch; prefetch() asks for them early.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) throw std::runtime_error("MappedFile: cannot open " + path);
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0 || st.st_size == 0) {
+            ::close(fd_);
+            throw std::runtime_error("MappedFile: " + path + " is empty or unreadable");
+        }
+        size_ = size_t(st.st_size);
+        void* map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd_);
+            throw std::runtime_error("MappedFile: mmap of " + path + " failed");
+        }
+        data_ = static_cast<const uint8_t*>(map);
+    }
+
+    ~MappedFile() {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+        ::close(fd_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    // True if [offset, offset + bytes) lies inside the file
+    bool contains(uint64_t offset, uint64_t bytes) const { return offset <= size_ && bytes <= size_ - offset; }
+
+    // Readahead hints; madvise wants page-aligned starts
+    void sequential() const { ::madvise(const_cast<uint8_t*>(data_), size_, MADV_SEQUENTIAL); }
+    void prefetch(size_t offset, size_t bytes) const {
+        static const size_t page = size_t(::sysconf(_SC_PAGESIZE));
+        const size_t aligned = offset / page * page;
+        ::madvise(const_cast<uint8_t*>(data_) + aligned, bytes + (offset - aligned), MADV_WILLNEED);
+    }
+
+private:
+    int fd_ = -1;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// Sub-allocates device memory for images and buffers from large blocks
+// instead of one vkAllocateMemory per resource. Requests are rounded up to
+// power-of-two size classes, naturally aligned within their block, so any
+// freed range can serve any later request of the same class. Freed ranges
+// go to a free list per (memory type, linear/optimal, class); a block whose
+// last range is freed starts over empty, so a resolution switch reuses the
+// memory of the previous resolution without new device allocations.
+// Requests above half a block get a dedicated allocation.
+// Host-visible blocks are mapped once; Allocation::mapped points into them.
+// Not thread-safe.
+class MemoryAllocator {
+public:
+    struct Allocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;            // size class (or dedicated size)
+        VkDeviceSize requested = 0;       // VkMemoryRequirements::size
+        void* mapped = nullptr;           // host pointer at offset, host-visible types only
+        uint32_t pool = 0;                // internal: pool index
+        uint32_t block = 0;               // internal: block index, kDedicated for own allocations
+    };
+
+    struct Stats {
+        uint32_t blocks = 0;              // shared blocks currently allocated
+        VkDeviceSize blockBytes = 0;
+        uint32_t dedicated = 0;           // live dedicated allocations
+        VkDeviceSize dedicatedBytes = 0;
+        uint32_t liveAllocations = 0;     // sub-allocations + dedicated
+        VkDeviceSize liveBytes = 0;       // size classes in use
+        VkDeviceSize requestedBytes = 0;  // what was asked for (liveBytes - this = rounding)
+        uint64_t deviceAllocations = 0;   // vkAllocateMemory calls so far
+        uint64_t reused = 0;              // requests served from a free list
+    };
+
+    static constexpr uint32_t kDedicated = ~0u;
+
+    MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize = VkDeviceSize(64) << 20);
+    ~MemoryAllocator();
+
+    MemoryAllocator(const MemoryAllocator&) = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+    // Allocates and binds; `preferred` flags are tried first on top of `required`
+    Allocation allocateImage(VkImage image, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred = 0);
+    Allocation allocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred = 0);
+    void free(Allocation& a);
+
+    // Returns blocks without live allocations to the driver
+    void trim();
+
+    Stats stats() const { return stats_; }
+    const VkPhysicalDeviceMemoryProperties& memoryProperties() const { return memProps_; }
+
+private:
+    struct Block {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        VkDeviceSize used = 0;            // bump offset
+        void* mapped = nullptr;
+        uint32_t live = 0;
+    };
+    struct FreeRange {
+        uint32_t block;
+        VkDeviceSize offset;
+    };
+    // One pool per (memory type, linear): buffers and optimal-tiling images never
+    // share a block, which keeps bufferImageGranularity out of the picture
+    struct Pool {
+        uint32_t memoryType = 0;
+        std::vector<Block> blocks;
+        std::map<VkDeviceSize, std::vector<FreeRange>> freeRanges;   // by size class
+    };
+
+    Allocation allocate(const VkMemoryRequirements& req, bool linear, VkMemoryPropertyFlags required,
+                        VkMemoryPropertyFlags preferred, VkDeviceSize requested);
+    VkDeviceMemory allocateDeviceMemory(uint32_t memoryType, VkDeviceSize size, void** mapped);
+
+    VkDevice device_;
+    VkDeviceSize blockSize_;
+    VkPhysicalDeviceMemoryProperties memProps_{};
+    std::vector<Pool> pools_;             // index = memoryType * 2 + linear
+    Stats stats_;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <string>
+#include <cstdint>
+#include "VulkanSetup.h"
+
+// VkPipelineCache persisted to a file, so later processes skip the driver's
+// shader compilation. The file starts with our own header (vendor/device ID,
+// driver version, pipelineCacheUUID); data written by another GPU or driver
+// build is dropped instead of being handed to the driver.
+class PipelineCache {
+public:
+    // path empty: in-memory cache only
+    PipelineCache(const VulkanSetup& vk, std::string path);
+    ~PipelineCache();   // save()
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    VkPipelineCache handle() const { return cache_; }
+    // True if the file was accepted when the cache was created
+    bool loaded() const { return loaded_; }
+
+    // Writes the file (via a temporary + rename) if the cache grew since the
+    // last load/save. Failures only warn: the cache is an optimization.
+    void save();
+
+private:
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t  uuid[VK_UUID_SIZE];
+        uint32_t reserved;     // explicit padding, keeps memcmp() well-defined
+        uint64_t dataSize;
+    };
+
+    FileHeader expectedHeader() const;
+
+    const VulkanSetup& vk_;
+    std::string path_;
+    VkPipelineCache cache_ = VK_NULL_HANDLE;
+    size_t savedSize_ = 0;
+    bool loaded_ = false;
+};
@@ -0,0 +1,12 @@
+#pragma once
+#include <vector>
+#include <string>
+
+// SPIR-V lookup for the compute pipelines. Builds with FAST_EMBED_SHADERS carry
+// every build/shaders/*.spv in the binary, so no files are needed at runtime.
+//   dir non-empty: read <dir>/<name> (shader development, overrides embedded)
+//   dir empty:     embedded copy, else the build tree's SHADER_DIR
+std::vector<char> loadShaderCode(const std::string& name, const std::string& dir = "");
+
+// True if this binary was built with embedded shaders
+bool hasEmbeddedShaders();
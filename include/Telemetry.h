@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Always-on metrics for long-running pipelines. Counters, gauges and histograms
+// are registered once and then updated with relaxed atomics, so the detection
+// thread never takes a lock; any thread can scrape() them at any time in the
+// Prometheus text format. The optional trace keeps the last maxTraceEvents host
+// and GPU spans in a ring and writes them as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev).
+//
+//     Telemetry telemetry(1 << 16);
+//     FastDetector::Options opts;
+//     opts.telemetry = &telemetry;          // must outlive the detector
+//     ...
+//     serveHttp("/metrics", telemetry.scrape());
+//     telemetry.writeTrace("fast.trace.json");
+class Telemetry {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Counter {
+    public:
+        void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+    private:
+        std::atomic<uint64_t> value_{0};
+    };
+
+    class Gauge {
+    public:
+        void set(double v) { value_.store(v, std::memory_order_relaxed); }
+        double value() const { return value_.load(std::memory_order_relaxed); }
+    private:
+        std::atomic<double> value_{0.0};
+    };
+
+    // Fixed buckets; observation v lands in the first bucket with v <= bound,
+    // or in the overflow bucket past the last bound
+    class Histogram {
+    public:
+        explicit Histogram(std::vector<double> bounds);
+        void observe(double v);
+
+        struct Snapshot {
+            std::vector<double> bounds;
+            std::vector<uint64_t> counts;   // per bucket (not cumulative), bounds.size() + 1
+            uint64_t count = 0;
+            double sum = 0;
+        };
+        Snapshot snapshot() const;
+
+    private:
+        std::vector<double> bounds_;
+        std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+        std::atomic<double> sum_{0.0};
+    };
+
+    // `count` bounds start, start * factor, ...
+    static std::vector<double> exponentialBuckets(double start, double factor, size_t count);
+    // Millisecond latencies, 0.01 ms .. ~5 s
+    static std::vector<double> latencyBuckets() { return exponentialBuckets(0.01, 2.0, 20); }
+
+    // maxTraceEvents = 0: no trace, span() returns immediately
+    explicit Telemetry(size_t maxTraceEvents = 0);
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // The returned metrics live as long as the Telemetry. Registering a name and
+    // label set again returns the existing metric; a name is one metric type.
+    // labels: Prometheus label pairs without braces, e.g. stage="detect"
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(const std::string& name, const std::string& help, std::vector<double> bounds,
+                         const std::string& labels = "");
+
+    // Prometheus text exposition format (version 0.0.4)
+    std::string scrape() const;
+
+    // Trace: one row per lane ("host", "gpu", ...); frame >= 0 is shown as an argument
+    bool tracing() const { return maxTraceEvents_ > 0; }
+    void span(const std::string& lane, const std::string& name, Clock::time_point start, Clock::duration duration,
+              int64_t frame = -1);
+    void writeTrace(const std::string& path) const;
+
+private:
+    struct Family {
+        std::string type, help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;     // by labels
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+    struct Event {
+        uint32_t lane;
+        std::string name;
+        double startUs, durationUs;   // since the Telemetry was created
+        int64_t frame;
+    };
+
+    Family& family(const std::string& name, const char* type, const std::string& help);
+
+    mutable std::mutex registryMutex_;
+    std::map<std::string, Family> families_;
+
+    const size_t maxTraceEvents_;
+    const Clock::time_point origin_ = Clock::now();
+    mutable std::mutex traceMutex_;
+    std::vector<std::string> lanes_;
+    std::deque<Event> events_;        // oldest dropped when full
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <queue>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <exception>
+
+// Fixed-size worker pool (header-only). submit() queues a task and returns its
+// future; parallelFor() splits an index range over the workers and the calling
+// thread and returns once every index was processed.
+class ThreadPool {
+public:
+    // threads = 0: one worker per hardware thread
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        workers_.reserve(threads);
+        for (unsigned i = 0; i < threads; ++i) workers_.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread& t : workers_) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return unsigned(workers_.size()); }
+
+    template <class F>
+    auto submit(F&& f) -> std::future<decltype(f())> {
+        using R = decltype(f());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace([task] { (*task)(); });
+        }
+        cv_.notify_one();
+        return result;
+    }
+
+    // Calls fn(i) for every i in [0, n). Indices are claimed dynamically, so uneven
+    // work (e.g. image strips with many corners) balances out. Rethrows the first
+    // exception thrown by fn. Must not be called from inside a pool task.
+    template <class F>
+    void parallelFor(size_t n, F&& fn) {
+        if (n == 0) return;
+        std::atomic<size_t> next{0};
+        auto run = [&] {
+            for (size_t i = next++; i < n; i = next++) fn(i);
+        };
+        const size_t helpers = std::min<size_t>(workers_.size(), n - 1);
+        std::vector<std::future<void>> pending;
+        pending.reserve(helpers);
+        for (size_t h = 0; h < helpers; ++h) pending.push_back(submit(run));
+        std::exception_ptr error;
+        try { run(); } catch (...) { error = std::current_exception(); }
+        for (auto& p : pending) {
+            try { p.get(); } catch (...) { if (!error) error = std::current_exception(); }
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (stop_ && tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
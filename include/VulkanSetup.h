@@ -11,6 +11,9 @@ public:
         const char* appName = "ComputeExample";
         uint32_t apiVersion = VK_API_VERSION_1_0;
         bool enableValidation = false; 
+        int deviceIndex = -1;           // vkEnumeratePhysicalDevices index; -1 = best scored device
+        bool dedicatedQueues = false;   // also create a transfer-only and a compute-only queue
+                                        // if the device exposes such families
     };
 
     VulkanSetup(const Options& opts);
@@ -28,15 +31,27 @@ public:
     VkDevice             device()             const { return device_; }
     VkQueue              computeQueue()       const { return computeQueue_; }
     uint32_t             computeQueueFamily() const { return computeQueueFamilyIndex_; }
+    // Dedicated queues (Options::dedicatedQueues); fall back to the compute queue.
+    // Exclusive resources shared with computeQueue() need ownership transfers
+    // whenever the family differs.
+    VkQueue              transferQueue()       const { return transferQueue_; }
+    uint32_t             transferQueueFamily() const { return transferQueueFamilyIndex_; }
+    VkQueue              asyncComputeQueue()       const { return asyncComputeQueue_; }
+    uint32_t             asyncComputeQueueFamily() const { return asyncComputeQueueFamilyIndex_; }
+    const char*          deviceName()         const { return deviceName_.c_str(); }
+    const VkPhysicalDeviceFeatures& enabledFeatures() const { return enabledFeatures_; }
+    // minImportedHostPointerAlignment if VK_EXT_external_memory_host is enabled, else 0
+    VkDeviceSize         hostImportAlignment() const { return hostImportAlignment_; }
 
 private:
     void createInstance(const Options& opts);
-    void pickPhysicalDeviceAndQueue();
+    void pickPhysicalDeviceAndQueue(const Options& opts);
     void createDeviceAndQueue();
 
     // Utility
     static bool hasExtension(const std::vector<VkExtensionProperties>& list, const char* name);
     static bool hasLayer(const std::vector<VkLayerProperties>& list, const char* name);
+    static int64_t scoreDevice(VkPhysicalDevice dev);
 
 private:
     VkInstance instance_ = VK_NULL_HANDLE;
@@ -44,6 +59,14 @@ private:
     uint32_t computeQueueFamilyIndex_ = 0;
     VkDevice device_ = VK_NULL_HANDLE;
     VkQueue computeQueue_ = VK_NULL_HANDLE;
+    uint32_t transferQueueFamilyIndex_ = 0;
+    VkQueue transferQueue_ = VK_NULL_HANDLE;
+    uint32_t asyncComputeQueueFamilyIndex_ = 0;
+    VkQueue asyncComputeQueue_ = VK_NULL_HANDLE;
+    std::string deviceName_;
+    VkPhysicalDeviceFeatures enabledFeatures_{ };
+    uint32_t apiVersion_ = VK_API_VERSION_1_0;
+    VkDeviceSize hostImportAlignment_ = 0;
 
     // For cleanup 
     bool portabilityEnabled_ = false;
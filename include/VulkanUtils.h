@@ -0,0 +1,96 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <cstdint>
+
+// Small helpers shared by the compute pipelines (header-only).
+
+inline void VK_CHECK(VkResult r, const char* where) {
+    if (r != VK_SUCCESS) throw std::runtime_error(std::string("Vulkan error at ") + where + " (" + std::to_string(r) + ")");
+}
+
+// `preferred` flags are tried first on top of `properties`, then dropped if no type has them.
+// memProps is queried once by the caller (see MemoryAllocator).
+inline uint32_t findMemoryType(uint32_t typeFilter, const VkPhysicalDeviceMemoryProperties& memProps,
+                               VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferred = 0) {
+    if (preferred != 0) {
+        VkMemoryPropertyFlags wanted = properties | preferred;
+        for (uint32_t i = 0; i < memProps.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (memProps.memoryTypes[i].propertyFlags & wanted) == wanted) {
+                return i;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < memProps.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+inline std::vector<char> readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + filename);
+    }
+    size_t fileSize = (size_t) file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+    return buffer;
+}
+
+inline void transitionImage(VkCommandBuffer cmd, VkImage img,
+                            VkImageLayout oldL, VkImageLayout newL,
+                            VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                            VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.oldLayout = oldL; b.newLayout = newL;
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.image = img;
+    b.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, VK_REMAINING_ARRAY_LAYERS};
+    b.srcAccessMask = srcAccess; b.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &b);
+}
+
+// Queue family ownership transfer of an image kept in GENERAL. Recorded twice: as
+// the release on the source queue (dstAccess 0) and as the acquire on the
+// destination queue (srcAccess 0), see "Queue Family Ownership Transfer".
+inline void transferImageOwnership(VkCommandBuffer cmd, VkImage img, uint32_t srcFamily, uint32_t dstFamily,
+                                   VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                                   VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.oldLayout = VK_IMAGE_LAYOUT_GENERAL; b.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    b.srcQueueFamilyIndex = srcFamily;
+    b.dstQueueFamilyIndex = dstFamily;
+    b.image = img;
+    b.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, VK_REMAINING_ARRAY_LAYERS};
+    b.srcAccessMask = srcAccess; b.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &b);
+}
+
+inline void bufferBarrier(VkCommandBuffer cmd, VkBuffer buf,
+                          VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                          VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkBufferMemoryBarrier b{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.buffer = buf; b.offset = 0; b.size = VK_WHOLE_SIZE;
+    b.srcAccessMask = srcAccess; b.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 1, &b, 0, nullptr);
+}
+
+inline void memoryBarrier(VkCommandBuffer cmd,
+                          VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                          VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkMemoryBarrier mb{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    mb.srcAccessMask = srcAccess;
+    mb.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 1, &mb, 0, nullptr, 0, nullptr);
+}
@@ -0,0 +1,67 @@
+#version 450
+// ORB smoothing: 7x7 Gaussian (sigma 2) of a pyramid level into smoothImg, layer
+// by layer (z = batch layer). Same kernel and BORDER_REFLECT_101 edges as the
+// cv::GaussianBlur that cv::ORB runs before its binary tests; the result is
+// rounded to the 8-bit value OpenCV would store. Separable through shared memory:
+// the 22x22 input tile is filtered horizontally, then vertically.
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// Same input variants as comp.comp.glsl
+#if defined(INPUT_R8UI)
+layout(binding = 0, r8ui) readonly uniform uimage2DArray inImg;
+#elif defined(INPUT_R8)
+layout(binding = 0, r8) readonly uniform image2DArray inImg;
+#else
+layout(binding = 0, rgba8) readonly uniform image2DArray inImg;
+#endif
+layout(binding = 1, r32f) writeonly uniform image2DArray smoothImg;   // intensities in [0,255]
+
+const int K = 3;                        // kernel radius
+const float W[4] = float[4](0.21610594, 0.19071282, 0.13107488, 0.07015933);   // getGaussianKernel(7, 2)
+const uint TILE = 16u + 2u * uint(K);
+shared float tile[TILE * TILE];
+shared float rows[TILE * 16u];          // horizontally filtered tile rows
+
+float intensity(ivec3 q) {
+#if defined(INPUT_R8UI)
+    return float(imageLoad(inImg, q).r);
+#elif defined(INPUT_R8)
+    return floor(imageLoad(inImg, q).r * 255.0 + 0.5);
+#else
+    return dot(imageLoad(inImg, q).rgb, vec3(0.299, 0.587, 0.114)) * 255.0;
+#endif
+}
+
+// BORDER_REFLECT_101: -1 -> 1, n -> n - 2
+int reflect101(int i, int n) {
+    i = abs(i);
+    return i >= n ? 2 * n - 2 - i : i;
+}
+
+void main() {
+    ivec2 size = imageSize(smoothImg).xy;
+    int layer = int(gl_GlobalInvocationID.z);
+    ivec2 origin = ivec2(gl_WorkGroupID.xy * gl_WorkGroupSize.xy) - K;
+    uint t = gl_LocalInvocationIndex;
+
+    for (uint i = t; i < TILE * TILE; i += 256u) {
+        ivec2 q = origin + ivec2(i % TILE, i / TILE);
+        tile[i] = intensity(ivec3(reflect101(q.x, size.x), reflect101(q.y, size.y), layer));
+    }
+    barrier();
+
+    for (uint i = t; i < TILE * 16u; i += 256u) {
+        uint r = i / 16u, c = i % 16u + uint(K);
+        float s = W[0] * tile[r * TILE + c];
+        for (uint k = 1u; k <= uint(K); ++k) s += W[k] * (tile[r * TILE + c - k] + tile[r * TILE + c + k]);
+        rows[i] = s;
+    }
+    barrier();
+
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    if (p.x >= size.x || p.y >= size.y) return;
+    uint c = gl_LocalInvocationID.x, r = gl_LocalInvocationID.y + uint(K);
+    float s = W[0] * rows[r * 16u + c];
+    for (uint k = 1u; k <= uint(K); ++k) s += W[k] * (rows[(r - k) * 16u + c] + rows[(r + k) * 16u + c]);
+    imageStore(smoothImg, ivec3(p, layer), vec4(floor(s + 0.5)));
+}
@@ -1,84 +1,254 @@
 #version 450
+// Workgroup size is selectable at pipeline creation (specialization constants 0 and 1)
 layout(local_size_x = 16, local_size_y = 16) in;
+layout(local_size_x_id = 0, local_size_y_id = 1) in;
 
-layout(binding = 0, rgba8) readonly  uniform image2D inImg;
-layout(binding = 1, rgba8) writeonly uniform image2D outImg;
+// Input variants (selected with -D at SPIR-V build time):
+//   INPUT_R8UI  - r8ui grayscale, integer intensities (like cv::FAST)
+//   INPUT_R8    - r8 (unorm) grayscale, rescaled to integer intensities
+//   default     - rgba8, float luminance, threshold rescaled to [0,1]
+// The segment-test pattern (specialization constants 3/4) and the threshold
+// (push constant) are chosen at runtime, see FastDetector::Options.
+// With WRITE_SCORES (specialization constant 2) every pixel's FAST score goes to
+// scoreImg instead of the keypoint list; nms.comp.glsl or grid.comp.glsl then
+// selects and compacts the keypoints.
+// Images are 2D arrays: each layer is one image of a batch, selected by
+// gl_GlobalInvocationID.z (one dispatch covers the whole batch).
+// TILED additionally stages the workgroup tile plus its R-pixel halo in shared
+// memory, so the segment test never touches the image again after the load.
+// With TILE_LIST (specialization constant 5) the dispatch is indirect and
+// sparse: workgroup i covers tile tiles[i] of the list tiles.comp.glsl built.
+#if defined(INPUT_R8UI)
+layout(binding = 0, r8ui) readonly uniform uimage2DArray inImg;
+#elif defined(INPUT_R8)
+layout(binding = 0, r8) readonly uniform image2DArray inImg;
+#else
+layout(binding = 0, rgba8) readonly uniform image2DArray inImg;
+#endif
 
-// --- Tunables ---
-const int  R = 6;              // circle radius for FAST-9
-const int  N = 9;              // contiguous arc length
-const float THRESH = 0.3;     // intensity threshold in [0,1]
+// Compacted keypoint list: count is bumped atomically, entries past the
+// buffer capacity are dropped (the host clamps count to the capacity).
+struct Keypoint {
+    uint  x;
+    uint  y;
+    float score;
+    uint  layer;   // batch index of the source image
+    uint  level;   // pyramid level, x/y are in that level's pixels
+};
+layout(std430, binding = 1) buffer KeypointBuffer {
+    uint     count;
+    Keypoint kps[];
+};
 
-// Circle offsets for radius 3, starting at top and going clockwise
-const ivec2 circle[16] = ivec2[16](
-    ivec2( 0,-6), ivec2( 2,-6), ivec2( 4,-5), ivec2( 5,-4),
-    ivec2( 6, 0), ivec2( 5, 4), ivec2( 4, 5), ivec2( 2, 6),
-    ivec2( 0, 6), ivec2(-2, 6), ivec2(-4, 5), ivec2(-5, 4),
-    ivec2(-6, 0), ivec2(-5,-4), ivec2(-4,-5), ivec2(-2,-6)
+layout(push_constant) uniform Params {
+    uint level;       // pyramid level of the bound input image, copied into every keypoint
+    uint threshold;   // intensity threshold in [0,255]
+} pc;
+
+// Only touched when WRITE_SCORES is set; the host binds a 1x1 placeholder otherwise
+layout(binding = 2, r32f) writeonly uniform image2DArray scoreImg;
+layout(constant_id = 2) const bool WRITE_SCORES = false;
+
+// Only read when TILE_LIST is set; the host binds the keypoint buffer otherwise
+layout(constant_id = 5) const bool TILE_LIST = false;
+layout(std430, binding = 3) readonly buffer TileList {
+    uvec4 dispatch;   // VkDispatchIndirectCommand of this level + padding
+    uint  tiles[];    // x | y << 16, in workgroups
+};
+
+// Workgroup position in the level, in workgroups
+uvec2 workGroup() {
+    if (!TILE_LIST) return gl_WorkGroupID.xy;
+    uint t = tiles[gl_WorkGroupID.x];
+    return uvec2(t & 0xffffu, t >> 16);
+}
+
+// --- Segment-test pattern ---
+// CIRCLE pixels on a Bresenham circle, ARC of them contiguous must all be
+// brighter or all darker than the centre (the cv::FastFeatureDetector types):
+//   FAST-9/16: radius 3, FAST-7/12: radius 2, FAST-5/8: radius 1
+layout(constant_id = 3) const int CIRCLE = 16;
+layout(constant_id = 4) const int ARC = 9;
+const int R = CIRCLE == 16 ? 3 : (CIRCLE == 12 ? 2 : 1);
+// Pixels closer than this to the image edge are never corners, for every
+// pattern (as cv::FAST)
+const int BORDER = 3;
+
+#if defined(INPUT_R8UI) || defined(INPUT_R8)
+#define pix_t int
+#else
+#define pix_t float
+#endif
+
+// Circle offsets starting at the top and going clockwise; the compass points
+// (top, right, bottom, left) are every CIRCLE/4-th entry
+const ivec2 circle16[16] = ivec2[16](
+    ivec2( 0,-3), ivec2( 1,-3), ivec2( 2,-2), ivec2( 3,-1),
+    ivec2( 3, 0), ivec2( 3, 1), ivec2( 2, 2), ivec2( 1, 3),
+    ivec2( 0, 3), ivec2(-1, 3), ivec2(-2, 2), ivec2(-3, 1),
+    ivec2(-3, 0), ivec2(-3,-1), ivec2(-2,-2), ivec2(-1,-3)
+);
+const ivec2 circle12[12] = ivec2[12](
+    ivec2( 0,-2), ivec2( 1,-2), ivec2( 2,-1), ivec2( 2, 0),
+    ivec2( 2, 1), ivec2( 1, 2), ivec2( 0, 2), ivec2(-1, 2),
+    ivec2(-2, 1), ivec2(-2, 0), ivec2(-2,-1), ivec2(-1,-2)
+);
+const ivec2 circle8[8] = ivec2[8](
+    ivec2( 0,-1), ivec2( 1,-1), ivec2( 1, 0), ivec2( 1, 1),
+    ivec2( 0, 1), ivec2(-1, 1), ivec2(-1, 0), ivec2(-1,-1)
 );
 
+// CIRCLE is a constant after specialization, so the selection folds away
+ivec2 circle(int i) {
+    if (CIRCLE == 16) return circle16[i];
+    if (CIRCLE == 12) return circle12[i];
+    return circle8[i];
+}
+
+// Layer of the batch this invocation works on
+int layer;
+
+#if defined(INPUT_R8UI)
+pix_t intensity(ivec2 p) {
+    return int(imageLoad(inImg, ivec3(p, layer)).r);
+}
+#elif defined(INPUT_R8)
+pix_t intensity(ivec2 p) {
+    return int(imageLoad(inImg, ivec3(p, layer)).r * 255.0 + 0.5);
+}
+#else
 float luminance(vec4 rgba) {
     return dot(rgba.rgb, vec3(0.299, 0.587, 0.114));
 }
 
-bool isCorner(ivec2 p, ivec2 size) {
-    if (p.x < R || p.y < R || p.x >= size.x - R || p.y >= size.y - R)
-        return false;
+pix_t intensity(ivec2 p) {
+    return luminance(imageLoad(inImg, ivec3(p, layer)));
+}
+#endif
 
-    float I0 = luminance(imageLoad(inImg, p));
-    bool bright[32];
-    bool dark[32];
+#ifdef TILED
+const uint TILE_W = gl_WorkGroupSize.x + 2u * uint(R);
+const uint TILE_H = gl_WorkGroupSize.y + 2u * uint(R);
+shared pix_t tile[TILE_W * TILE_H];
+ivec2 tileOrigin;
 
-    for (int i = 0; i < 16; ++i) {
-        float Ii = luminance(imageLoad(inImg, p + circle[i]));
-        bright[i] = (Ii >= I0 + THRESH);
-        dark[i]   = (Ii <= I0 - THRESH);
-        bright[i+16] = bright[i];
-        dark[i+16]   = dark[i];
+// Cooperative load: every invocation strides over the (tile + halo) area.
+// Must be reached by the whole workgroup, i.e. before any early return.
+void loadTile(ivec2 size) {
+    tileOrigin = ivec2(workGroup() * gl_WorkGroupSize.xy) - ivec2(R);
+    uint groupSize = gl_WorkGroupSize.x * gl_WorkGroupSize.y;
+    for (uint i = gl_LocalInvocationIndex; i < TILE_W * TILE_H; i += groupSize) {
+        ivec2 q = tileOrigin + ivec2(i % TILE_W, i / TILE_W);
+        tile[i] = intensity(clamp(q, ivec2(0), size - 1));
     }
+    memoryBarrierShared();
+    barrier();
+}
 
-    int runB = 0, runD = 0;
-    for (int i = 0; i < 16 + N - 1; ++i) {
-        runB = bright[i] ? (runB + 1) : 0;
-        runD = dark[i]   ? (runD + 1) : 0;
-        if (runB >= N || runD >= N) return true;
-    }
-    return false;
+pix_t fetch(ivec2 q) {
+    ivec2 t = q - tileOrigin;
+    return tile[uint(t.y) * TILE_W + uint(t.x)];
+}
+#else
+pix_t fetch(ivec2 q) {
+    return intensity(q);
 }
+#endif
 
-void drawCircle(ivec2 center, ivec2 size) {
-    // Red overlay color
-    vec4 red = vec4(1.0, 0.0, 0.0, 1.0);
-    int R2 = R * R;
-
-    for (int dy = -R; dy <= R; ++dy) {
-        for (int dx = -R; dx <= R; ++dx) {
-            ivec2 q = center + ivec2(dx, dy);
-            if (q.x < 0 || q.y < 0 || q.x >= size.x || q.y >= size.y) continue;
-
-            int d2 = dx*dx + dy*dy;
-            if (abs(d2 - R2) <= 2) { // pixels close to radius
-                vec4 orig = imageLoad(inImg, q);
-                vec4 blended = mix(orig, red, 0.8); // blend red with original
-                imageStore(outImg, q, blended);
-            }
+// Any arc of ARC contiguous circle pixels covers at least this many compass
+// points - fewer bright (or dark) ones rejects the pixel.
+const int COMPASS_STEP = CIRCLE / 4;
+const int COMPASS_MIN = ARC / COMPASS_STEP;
+
+// True if the CIRCLE-bit mask has a run of ARC set bits, wrap-around included.
+bool hasArc(uint mask) {
+    uint m = mask | (mask << CIRCLE);   // unrolled circle, runs across the last bit become contiguous
+    uint run = m;
+    for (int i = 1; i < ARC; ++i)
+        run &= m >> i;                  // bit j survives iff bits j..j+i are all set
+    return run != 0u;
+}
+
+// FAST score: the best arc of ARC pixels by its weakest brighter (or darker)
+// difference. A pixel is a corner iff its score exceeds the threshold.
+pix_t cornerScore(ivec2 p, pix_t I0) {
+    pix_t d[16];
+    for (int i = 0; i < CIRCLE; ++i)
+        d[i] = fetch(p + circle(i)) - I0;
+
+    pix_t best = pix_t(0);
+    for (int s = 0; s < CIRCLE; ++s) {
+        pix_t mn = d[s], mx = d[s];
+        for (int k = 1; k < ARC; ++k) {
+            pix_t v = d[(s + k) % CIRCLE];
+            mn = min(mn, v);
+            mx = max(mx, v);
         }
+        best = max(best, max(mn, -mx));
+    }
+    return best;
+}
+
+// Returns true for a corner and writes its FAST score. Like cv::FAST the
+// comparisons are strict: brighter means I > I0 + t, darker I < I0 - t.
+bool isCorner(ivec2 p, ivec2 size, out float score) {
+    score = 0.0;
+    if (p.x < BORDER || p.y < BORDER || p.x >= size.x - BORDER || p.y >= size.y - BORDER)
+        return false;
+
+#if defined(INPUT_R8UI) || defined(INPUT_R8)
+    pix_t t = int(pc.threshold);
+#else
+    pix_t t = float(pc.threshold) / 255.0;
+#endif
+    pix_t I0 = fetch(p);
+    pix_t hi = I0 + t;
+    pix_t lo = I0 - t;
+    uint bright = 0u, dark = 0u;
+
+    // High-speed test: compass points first, most pixels stop here
+    for (int i = 0; i < CIRCLE; i += COMPASS_STEP) {
+        pix_t Ii = fetch(p + circle(i));
+        if (Ii > hi) bright |= 1u << i;
+        if (Ii < lo) dark   |= 1u << i;
     }
+    if (bitCount(bright) < COMPASS_MIN && bitCount(dark) < COMPASS_MIN)
+        return false;
+
+    for (int i = 0; i < CIRCLE; ++i) {
+        if (i % COMPASS_STEP == 0) continue;
+        pix_t Ii = fetch(p + circle(i));
+        if (Ii > hi) bright |= 1u << i;
+        if (Ii < lo) dark   |= 1u << i;
+    }
+
+    if (!hasArc(bright) && !hasArc(dark))
+        return false;
+    score = float(cornerScore(p, I0));
+    return true;
 }
 
 void main() {
-    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
-    ivec2 size = imageSize(inImg);
+    ivec2 p = ivec2(workGroup() * gl_WorkGroupSize.xy + gl_LocalInvocationID.xy);
+    ivec2 size = imageSize(inImg).xy;
+    layer = int(gl_GlobalInvocationID.z);
 
+#ifdef TILED
+    loadTile(size);
+#endif
     if (p.x >= size.x || p.y >= size.y) return;
 
-    bool corner = isCorner(p, size);
-
+    float score;
+    bool corner = isCorner(p, size, score);
+    if (WRITE_SCORES) {
+        // Negative marks "not a corner" so a zero score stays a valid maximum
+        imageStore(scoreImg, ivec3(p, layer), vec4(corner ? score : -1.0));
+        return;
+    }
     if (corner) {
-        drawCircle(p, size);
-    } else {
-        // If not a corner, just copy the input pixel
-        vec4 px = imageLoad(inImg, p);
-        imageStore(outImg, p, px);
+        uint idx = atomicAdd(count, 1u);
+        if (idx < uint(kps.length())) {
+            kps[idx] = Keypoint(uint(p.x), uint(p.y), score, uint(layer), pc.level);
+        }
     }
 }
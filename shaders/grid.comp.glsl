@@ -0,0 +1,99 @@
+#version 450
+// Grid-bucketed top-K selection over the score image written by comp.comp.glsl
+// (WRITE_SCORES). One workgroup per CELL x CELL cell and batch layer: the cell's
+// candidates are staged in shared memory, then TOP_K rounds of a workgroup
+// argmax reduction pick the strongest ones, which are the only keypoints
+// appended to the list. With NMS set, only strict 3x3 maxima are candidates
+// (same rule as nms.comp.glsl), so this pass replaces the NMS pass.
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(constant_id = 0) const uint CELL = 32;   // cell edge in pixels of the level
+layout(constant_id = 1) const bool NMS = false;
+
+layout(binding = 0, r32f) readonly uniform image2DArray scoreImg;
+
+struct Keypoint {
+    uint  x;
+    uint  y;
+    float score;
+    uint  layer;
+    uint  level;
+};
+layout(std430, binding = 1) buffer KeypointBuffer {
+    uint     count;
+    Keypoint kps[];
+};
+
+layout(push_constant) uniform Params {
+    uint level;   // pyramid level of the bound score image
+    uint topK;    // keypoints kept per cell
+} pc;
+
+const uint GROUP = 256u;
+shared float cand[CELL * CELL];   // candidate score per cell pixel, < 0 = none
+shared float redScore[GROUP];
+shared uint  redIdx[GROUP];
+
+float candidate(ivec2 p, int layer, ivec2 size) {
+    if (p.x >= size.x || p.y >= size.y) return -1.0;
+    float s = imageLoad(scoreImg, ivec3(p, layer)).r;
+    if (s < 0.0 || !NMS) return s;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0) continue;
+            ivec2 q = p + ivec2(dx, dy);
+            if (q.x < 0 || q.y < 0 || q.x >= size.x || q.y >= size.y) continue;
+            if (imageLoad(scoreImg, ivec3(q, layer)).r >= s) return -1.0;
+        }
+    }
+    return s;
+}
+
+// Higher score wins, ties go to the lower index so the result is deterministic
+bool better(float sa, uint ia, float sb, uint ib) {
+    return sa > sb || (sa == sb && ia < ib);
+}
+
+void main() {
+    ivec2 size = imageSize(scoreImg).xy;
+    int layer = int(gl_WorkGroupID.z);
+    ivec2 origin = ivec2(gl_WorkGroupID.xy * CELL);
+    uint t = gl_LocalInvocationIndex;
+
+    for (uint i = t; i < CELL * CELL; i += GROUP)
+        cand[i] = candidate(origin + ivec2(i % CELL, i / CELL), layer, size);
+    barrier();
+
+    for (uint k = 0u; k < pc.topK; ++k) {
+        // Per-invocation best, then a tree reduction over the workgroup
+        float bs = -1.0;
+        uint  bi = 0xFFFFFFFFu;
+        for (uint i = t; i < CELL * CELL; i += GROUP) {
+            if (better(cand[i], i, bs, bi)) { bs = cand[i]; bi = i; }
+        }
+        redScore[t] = bs;
+        redIdx[t] = bi;
+        barrier();
+        for (uint stride = GROUP / 2u; stride > 0u; stride >>= 1) {
+            if (t < stride && better(redScore[t + stride], redIdx[t + stride], redScore[t], redIdx[t])) {
+                redScore[t] = redScore[t + stride];
+                redIdx[t] = redIdx[t + stride];
+            }
+            barrier();
+        }
+
+        // Uniform exit: every invocation reads the same shared winner
+        float ws = redScore[0];
+        uint  wi = redIdx[0];
+        if (ws < 0.0) break;
+        if (t == 0u) {
+            cand[wi] = -1.0;
+            uint idx = atomicAdd(count, 1u);
+            if (idx < uint(kps.length())) {
+                ivec2 p = origin + ivec2(wi % CELL, wi / CELL);
+                kps[idx] = Keypoint(uint(p.x), uint(p.y), ws, uint(layer), pc.level);
+            }
+        }
+        barrier();
+    }
+}
@@ -0,0 +1,48 @@
+#version 450
+// 3x3 non-maximum suppression over the score image written by comp.comp.glsl
+// (WRITE_SCORES). A corner survives only if its score is strictly greater than all
+// eight neighbours in its own layer, like cv::FAST; survivors are compacted
+// into the keypoint list.
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0, r32f) readonly uniform image2DArray scoreImg;
+
+struct Keypoint {
+    uint  x;
+    uint  y;
+    float score;
+    uint  layer;
+    uint  level;
+};
+
+layout(push_constant) uniform Params {
+    uint level;   // pyramid level of the bound score image
+} pc;
+layout(std430, binding = 1) buffer KeypointBuffer {
+    uint     count;
+    Keypoint kps[];
+};
+
+void main() {
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    int layer = int(gl_GlobalInvocationID.z);
+    ivec2 size = imageSize(scoreImg).xy;
+    if (p.x >= size.x || p.y >= size.y) return;
+
+    float s = imageLoad(scoreImg, ivec3(p, layer)).r;
+    if (s < 0.0) return; // not a corner
+
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0) continue;
+            ivec2 q = p + ivec2(dx, dy);
+            if (q.x < 0 || q.y < 0 || q.x >= size.x || q.y >= size.y) continue;
+            if (imageLoad(scoreImg, ivec3(q, layer)).r >= s) return;
+        }
+    }
+
+    uint idx = atomicAdd(count, 1u);
+    if (idx < uint(kps.length())) {
+        kps[idx] = Keypoint(uint(p.x), uint(p.y), s, uint(layer), pc.level);
+    }
+}
@@ -0,0 +1,142 @@
+#version 450
+// ORB features of the final keypoint list, one invocation per list entry; run
+// once per pyramid level, entries of other levels return right away.
+//   angle: intensity centroid over the radius-15 disc around the keypoint in the
+//          level image, in degrees [0, 360) as cv::KeyPoint::angle (cv::ORB's ICAngle)
+//   descriptor: cv::ORB's 256 learned point pairs rotated by the angle, compared
+//          on the smoothed level (blur.comp.glsl); bit j is set if the first
+//          point is darker, stored at byte j / 8, bit j % 8 - the row layout
+//          of cv::ORB::compute()
+// Samples outside the level are clamped; cv::ORB drops keypoints closer than
+// edgeThreshold (31) to the border instead.
+layout(local_size_x = 64) in;
+
+// Same input variants as comp.comp.glsl
+#if defined(INPUT_R8UI)
+layout(binding = 0, r8ui) readonly uniform uimage2DArray inImg;
+#elif defined(INPUT_R8)
+layout(binding = 0, r8) readonly uniform image2DArray inImg;
+#else
+layout(binding = 0, rgba8) readonly uniform image2DArray inImg;
+#endif
+layout(binding = 1, r32f) readonly uniform image2DArray smoothImg;
+
+struct Keypoint {
+    uint  x;
+    uint  y;
+    float score;
+    uint  layer;
+    uint  level;
+};
+layout(std430, binding = 2) readonly buffer KeypointBuffer {
+    uint     count;
+    Keypoint kps[];
+};
+layout(std430, binding = 3) writeonly buffer DescriptorBuffer {
+    uint desc[];      // 8 words = 32 bytes per keypoint
+};
+layout(std430, binding = 4) writeonly buffer AngleBuffer {
+    float angle[];
+};
+
+layout(push_constant) uniform Params {
+    uint level;   // pyramid level of the bound images
+} pc;
+
+const int HALF_PATCH = 15;
+// Half-width of the disc per row |v|, symmetric as built by cv::ORB
+const int UMAX[16] = int[16](15, 15, 15, 15, 14, 14, 14, 13, 13, 12, 11, 10, 9, 8, 6, 3);
+
+// bit_pattern_31_ of cv::ORB: test j compares (x0, y0) with (x1, y1), packed as
+// signed bytes x0 | y0 << 8 | x1 << 16 | y1 << 24
+const uint PATTERN[256] = uint[256](
+    0x0509fd08u, 0xf4070204u, 0x02f809f5u, 0xf30cf407u, 0x0c02f302u, 0x0601f901u, 0xfcfef6feu, 0xf8f5f3f3u,
+    0xf7f4fdf3u, 0x090b040au, 0xf7f8f8f3u, 0x0cf707f5u, 0x060c0707u, 0x00fdfbfcu, 0xfdf402f3u, 0x05f900f7u,
+    0xff0cfa0cu, 0x0cfe06fdu, 0xf8fcf3fau, 0xf80cf30bu, 0x01050704u, 0xfd0afd05u, 0x0c06f903u, 0xfefaf9f8u,
+    0xf6ff0bfeu, 0x0af80cf3u, 0xfdfb03f9u, 0x07fd02fcu, 0x0bfaf4f6u, 0xf906f405u, 0xff07fa05u, 0xfb040001u,
+    0xf30b0b09u, 0x0c040704u, 0x0404ff02u, 0x07fef4fcu, 0xf6f9fbf8u, 0x0c090b04u, 0xf301f800u, 0x02f8fef3u,
+    0x03fefefdu, 0xf7fc09fau, 0x070a0c08u, 0x03010900u, 0xf60bfb07u, 0x00f5faf3u, 0x010c070au, 0x0cfafdfau,
+    0xfc0cf70au, 0xf4f808f3u, 0xfcf800f3u, 0x08070303u, 0xf90a0705u, 0xf40107ffu, 0x0605f603u, 0xf603fc02u,
+    0x05f300f3u, 0x0cf4f9f3u, 0x08f503f3u, 0x07fc0cf9u, 0x080cf606u, 0xfaf9fff7u, 0x0c00fbfeu, 0x05f905f4u,
+    0xf308f603u, 0x05fcf9f9u, 0xf9fffefdu, 0xf5050902u, 0xf3fbf3f5u, 0xff0006ffu, 0x0205fd05u, 0x0cfcf3fcu,
+    0x06f7faf7u, 0xfcf8f6f4u, 0xfd0c020au, 0x0c0c0c07u, 0x05faf3f9u, 0x04fd09fcu, 0x020cff07u, 0x01fb06f9u,
+    0x05f40bf3u, 0xfafe07fdu, 0xf90cf807u, 0xf4f5f9f3u, 0x0c0cfd01u, 0x0003fa02u, 0xf3fe03fcu, 0x0901f3ffu,
+    0xfa080107u, 0x0c03ff01u, 0x060c0109u, 0x03fff7ffu, 0x05f6f3f3u, 0x0c0a0707u, 0x090cfb0cu, 0x0b070306u,
+    0x0a06f305u, 0x0302f402u, 0xfa040803u, 0xf30c0602u, 0x030af409u, 0x09f904f8u, 0xfafc0cf5u, 0xf8020c01u,
+    0xfc07f706u, 0xfe030302u, 0x000b0306u, 0xf808fd03u, 0x03090807u, 0xfcfafbf5u, 0x0afb0bf6u, 0x0cfdf8fbu,
+    0x00f705f6u, 0xfa0cff08u, 0xf506fa04u, 0x07f80cf6u, 0x0706fe04u, 0x0cfe00feu, 0x02fbf8fbu, 0x0c0afa07u,
+    0xf8f8f3f7u, 0xfefbf3fbu, 0xf309f808u, 0x00f7f5f7u, 0xfe01f801u, 0x0109fc07u, 0xfcff01feu, 0xf50cfa0bu,
+    0x04faf7f4u, 0x0c070703u, 0x080a0505u, 0x0802fc00u, 0xf3fb0cf7u, 0x0c020700u, 0x070102ffu, 0xf7070b05u,
+    0xf8060503u, 0x09f8fcf3u, 0xfdfd09fbu, 0xf4fdf9fcu, 0x00080506u, 0x0cfa06f9u, 0xfefb06f3u, 0x0a03f601u,
+    0xfc080104u, 0xf302fefeu, 0x0c0cf402u, 0xfa00f3feu, 0x03090104u, 0xfbfdf6fau, 0x01fff3fdu, 0xf50c0507u,
+    0xf905fe04u, 0xfbf709f3u, 0x06080107u, 0x0607f807u, 0x01f9fcf9u, 0xf8f90bf8u, 0xf8f406f3u, 0x09030402u,
+    0x030cfb0au, 0x07fafbfau, 0xf809fd08u, 0x0802f402u, 0x03f6fef5u, 0xf7f9f3f4u, 0xfbf600f5u, 0x080bfd05u,
+    0x0cfff3feu, 0x0900f8ffu, 0xfbf4f5f3u, 0x0bf6fef6u, 0xf3fe09fdu, 0x0203fd02u, 0x00fcf3f7u, 0xf6fd06fcu,
+    0xf9fe0cfcu, 0x09fcf5fau, 0x0b06fd06u, 0x05fb0bf3u, 0x060c0b0bu, 0xfe0cfb07u, 0x07000cffu, 0xfefdf8fcu,
+    0x07fa01f9u, 0xf3f8f4f3u, 0xf8fafef9u, 0xf7fa05f8u, 0x05fcfffbu, 0x0af807f3u, 0xf3050501u, 0xf30a0001u,
+    0xff0a0c09u, 0xf70af805u, 0xf3010bffu, 0x02fafdf7u, 0x0c01f6ffu, 0xf6f801f3u, 0xfa0af508u, 0xfa03f302u,
+    0xf70cf307u, 0xf9fbf6f6u, 0xf3f8f8f6u, 0x0508fa04u, 0xf3080c03u, 0xfdfd02fcu, 0xf40af305u, 0xff05f304u,
+    0x03fc09f7u, 0xf7030300u, 0x01fa01f4u, 0xf8040203u, 0x09f6f6f6u, 0x0c0cf308u, 0xfbfaf4f8u, 0x07030202u,
+    0xf80b060au, 0xf4080806u, 0x05fa0af9u, 0x09fdf7fdu, 0x05fff3ffu, 0x04fdf9fdu, 0x03f8fef8u, 0x0c0c0204u,
+    0x0b03fb02u, 0xf30bf706u, 0x0c07ff03u, 0x040cff0bu, 0x06fd00fdu, 0x0c04f504u, 0x0102fc02u, 0x01f8faf6u,
+    0x01f507f3u, 0xf3f50cf3u, 0xf30b0006u, 0x0401ff00u, 0xfef703f3u, 0xfdfa08f7u, 0xfef8faf3u, 0x0a08f705u,
+    0xf7030702u, 0xfffffaffu, 0xfe0b0509u, 0xf80cfd0bu, 0x05030003u, 0x0a0004ffu, 0x0504fa03u, 0x05f600f3u,
+    0x0b0c0805u, 0xfa090908u, 0xf408fc07u, 0x09f604f6u, 0x040c0307u, 0xfe0af909u, 0xfe0c0007u, 0xf500faffu
+);
+
+ivec2 size;
+int layer;
+
+float intensity(ivec2 q) {
+    ivec3 c = ivec3(clamp(q, ivec2(0), size - 1), layer);
+#if defined(INPUT_R8UI)
+    return float(imageLoad(inImg, c).r);
+#elif defined(INPUT_R8)
+    return floor(imageLoad(inImg, c).r * 255.0 + 0.5);
+#else
+    return dot(imageLoad(inImg, c).rgb, vec3(0.299, 0.587, 0.114)) * 255.0;
+#endif
+}
+
+float smoothed(ivec2 q) {
+    return imageLoad(smoothImg, ivec3(clamp(q, ivec2(0), size - 1), layer)).r;
+}
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= min(count, uint(kps.length()))) return;
+    Keypoint kp = kps[i];
+    if (kp.level != pc.level) return;
+    size = imageSize(smoothImg).xy;
+    layer = int(kp.layer);
+    ivec2 c = ivec2(kp.x, kp.y);
+
+    float m01 = 0.0, m10 = 0.0;
+    for (int v = -HALF_PATCH; v <= HALF_PATCH; ++v) {
+        int d = UMAX[abs(v)];
+        for (int u = -d; u <= d; ++u) {
+            float I = intensity(c + ivec2(u, v));
+            m10 += float(u) * I;
+            m01 += float(v) * I;
+        }
+    }
+    // atan(0, 0) is undefined in GLSL; cv::fastAtan2 gives 0 for a flat patch
+    float a = (m01 == 0.0 && m10 == 0.0) ? 0.0 : atan(m01, m10);
+    float deg = degrees(a);
+    angle[i] = deg < 0.0 ? deg + 360.0 : deg;
+
+    // Rotated test points are rounded half to even, as cvRound
+    float ca = cos(a), sa = sin(a);
+    for (uint w = 0u; w < 8u; ++w) {
+        uint bits = 0u;
+        for (uint b = 0u; b < 32u; ++b) {
+            int p = int(PATTERN[w * 32u + b]);
+            vec4 pts = vec4(bitfieldExtract(p, 0, 8), bitfieldExtract(p, 8, 8),
+                            bitfieldExtract(p, 16, 8), bitfieldExtract(p, 24, 8));
+            ivec2 q0 = ivec2(roundEven(vec2(pts.x * ca - pts.y * sa, pts.x * sa + pts.y * ca)));
+            ivec2 q1 = ivec2(roundEven(vec2(pts.z * ca - pts.w * sa, pts.z * sa + pts.w * ca)));
+            if (smoothed(c + q0) < smoothed(c + q1)) bits |= 1u << b;
+        }
+        desc[i * 8u + w] = bits;
+    }
+}
@@ -0,0 +1,83 @@
+#version 450
+// Debug pass, dispatched twice:
+//   drawRings == 0: one invocation per pixel and layer copies the input (gray expanded) into outImg
+//   drawRings == 1: one invocation per keypoint draws a red ring into its layer of outImg,
+//                   scaled from its pyramid level back to full resolution
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// Same input variants as comp.comp.glsl
+#if defined(INPUT_R8UI)
+layout(binding = 0, r8ui) readonly uniform uimage2DArray inImg;
+#elif defined(INPUT_R8)
+layout(binding = 0, r8) readonly uniform image2DArray inImg;
+#else
+layout(binding = 0, rgba8) readonly uniform image2DArray inImg;
+#endif
+layout(binding = 1, rgba8) writeonly uniform image2DArray outImg;
+
+struct Keypoint {
+    uint  x;
+    uint  y;
+    float score;
+    uint  layer;
+    uint  level;
+};
+layout(std430, binding = 2) readonly buffer KeypointBuffer {
+    uint     count;
+    Keypoint kps[];
+};
+
+layout(push_constant) uniform Params {
+    uint  drawRings;
+    float levelScale;  // size ratio between consecutive pyramid levels
+} pc;
+
+const int R = 6;
+
+vec4 inputColor(ivec3 q) {
+#if defined(INPUT_R8UI)
+    return vec4(vec3(float(imageLoad(inImg, q).r) / 255.0), 1.0);
+#elif defined(INPUT_R8)
+    return vec4(vec3(imageLoad(inImg, q).r), 1.0);
+#else
+    return imageLoad(inImg, q);
+#endif
+}
+
+void drawCircle(ivec2 center, int radius, int layer, ivec2 size) {
+    // Red overlay color
+    vec4 red = vec4(1.0, 0.0, 0.0, 1.0);
+    int R2 = radius * radius;
+
+    for (int dy = -radius; dy <= radius; ++dy) {
+        for (int dx = -radius; dx <= radius; ++dx) {
+            ivec2 q = center + ivec2(dx, dy);
+            if (q.x < 0 || q.y < 0 || q.x >= size.x || q.y >= size.y) continue;
+
+            int d2 = dx*dx + dy*dy;
+            if (abs(d2 - R2) <= max(2, radius / 3)) { // pixels close to radius
+                // Blend against the untouched input so overlapping rings stay deterministic
+                vec4 blended = mix(inputColor(ivec3(q, layer)), red, 0.8);
+                imageStore(outImg, ivec3(q, layer), blended);
+            }
+        }
+    }
+}
+
+void main() {
+    ivec2 size = imageSize(inImg).xy;
+
+    if (pc.drawRings == 0u) {
+        ivec3 p = ivec3(gl_GlobalInvocationID);
+        if (p.x >= size.x || p.y >= size.y) return;
+        imageStore(outImg, p, inputColor(p));
+        return;
+    }
+
+    uint i = gl_WorkGroupID.x * 256u + gl_LocalInvocationIndex;
+    if (i >= min(count, uint(kps.length()))) return;
+
+    float scale = pow(pc.levelScale, float(kps[i].level));
+    ivec2 center = ivec2(vec2(kps[i].x, kps[i].y) * scale + 0.5 * (scale - 1.0));
+    drawCircle(center, int(float(R) * scale + 0.5), int(kps[i].layer), size);
+}
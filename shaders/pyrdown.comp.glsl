@@ -0,0 +1,43 @@
+#version 450
+// Pyramid step: resamples level L-1 (srcImg) into the smaller level L (dstImg),
+// layer by layer (z = batch layer). The scale is implied by the two image sizes.
+// Bilinear at the destination pixel centre, which for a factor of 2 is exactly
+// the 2x2 box average.
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// Same input variants as comp.comp.glsl; every pyramid level has the input format
+#if defined(INPUT_R8UI)
+layout(binding = 0, r8ui) readonly uniform uimage2DArray srcImg;
+layout(binding = 1, r8ui) writeonly uniform uimage2DArray dstImg;
+#elif defined(INPUT_R8)
+layout(binding = 0, r8) readonly uniform image2DArray srcImg;
+layout(binding = 1, r8) writeonly uniform image2DArray dstImg;
+#else
+layout(binding = 0, rgba8) readonly uniform image2DArray srcImg;
+layout(binding = 1, rgba8) writeonly uniform image2DArray dstImg;
+#endif
+
+vec4 load(ivec2 q, int layer, ivec2 size) {
+    return vec4(imageLoad(srcImg, ivec3(clamp(q, ivec2(0), size - 1), layer)));
+}
+
+void main() {
+    ivec3 p = ivec3(gl_GlobalInvocationID);
+    ivec2 dstSize = imageSize(dstImg).xy;
+    if (p.x >= dstSize.x || p.y >= dstSize.y) return;
+
+    ivec2 srcSize = imageSize(srcImg).xy;
+    vec2 s = (vec2(p.xy) + 0.5) * vec2(srcSize) / vec2(dstSize) - 0.5;
+    ivec2 q = ivec2(floor(s));
+    vec2 f = s - vec2(q);
+
+    vec4 top = mix(load(q,               p.z, srcSize), load(q + ivec2(1, 0), p.z, srcSize), f.x);
+    vec4 bot = mix(load(q + ivec2(0, 1), p.z, srcSize), load(q + ivec2(1, 1), p.z, srcSize), f.x);
+    vec4 v = mix(top, bot, f.y);
+
+#if defined(INPUT_R8UI)
+    imageStore(dstImg, p, uvec4(v + 0.5));
+#else
+    imageStore(dstImg, p, v);
+#endif
+}
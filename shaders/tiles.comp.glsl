@@ -0,0 +1,50 @@
+#version 450
+// Active-tile list for tile-sparse FAST (FastDetector::Options::tileMask).
+// A tile is one FAST workgroup (workgroupX x workgroupY pixels of a pyramid
+// level); one invocation per tile of the level checks the level-0 tiles under
+// its footprint in the host-written mask and appends the tile if any of them is
+// enabled. The append counter is the x of the VkDispatchIndirectCommand that
+// comp.comp.glsl (TILE_LIST) is dispatched with; y and z are set by the host.
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// Level-0 tile grid, row-major, 0 = skip
+layout(std430, binding = 0) readonly buffer TileMask {
+    uint mask[];
+};
+
+// This level's region of the tile buffer (the list has room for every tile)
+layout(std430, binding = 1) buffer TileList {
+    uint groupsX;
+    uint groupsY;
+    uint groupsZ;
+    uint pad;
+    uint tiles[];   // x | y << 16, in tiles of the level
+};
+
+layout(push_constant) uniform Params {
+    uvec2 levelTiles;   // tile grid of this level
+    uvec2 grid;         // level-0 tile grid
+    vec2  scale;        // level-0 pixels per level pixel (= level-0 tiles per level tile)
+} pc;
+
+void main() {
+    uvec2 t = gl_GlobalInvocationID.xy;
+    if (t.x >= pc.levelTiles.x || t.y >= pc.levelTiles.y) return;
+
+    // Footprint in level-0 tiles, at least one
+    uvec2 g0 = min(uvec2(vec2(t) * pc.scale), pc.grid - 1u);
+    uvec2 g1 = max(min(uvec2(ceil(vec2(t + 1u) * pc.scale)), pc.grid), g0 + 1u);
+    bool active = false;
+    for (uint y = g0.y; y < g1.y && !active; ++y) {
+        for (uint x = g0.x; x < g1.x; ++x) {
+            if (mask[y * pc.grid.x + x] != 0u) {
+                active = true;
+                break;
+            }
+        }
+    }
+    if (active) {
+        uint idx = atomicAdd(groupsX, 1u);
+        tiles[idx] = t.x | (t.y << 16);
+    }
+}
@@ -0,0 +1,148 @@
+#version 450
+// Sparse pyramidal Lucas-Kanade (cv::calcOpticalFlowPyrLK without the initial
+// flow flag): one workgroup per point, dispatched once per pyramid level from
+// the coarsest to level 0. prevImg is a level of the previously submitted frame,
+// nextImg the same level of the current one. Between dispatches the estimate is
+// kept in level-0 pixels in TrackPoint::next, so each level refines the last.
+// Intensities are in [0,1] for the solve; the reported error is in gray levels.
+layout(local_size_x = 64) in;
+
+layout(constant_id = 0) const uint WIN = 21;            // window edge in pixels (odd)
+layout(constant_id = 1) const uint ITERATIONS = 30;
+layout(constant_id = 2) const float EPSILON = 0.01;     // stop once an update is shorter (pixels)
+layout(constant_id = 3) const float MIN_EIGEN = 1e-4;   // smaller gradient-matrix eigenvalue per window pixel
+
+// Same input variants as comp.comp.glsl
+#if defined(INPUT_R8UI)
+layout(binding = 0, r8ui) readonly uniform uimage2DArray prevImg;
+layout(binding = 1, r8ui) readonly uniform uimage2DArray nextImg;
+#elif defined(INPUT_R8)
+layout(binding = 0, r8) readonly uniform image2DArray prevImg;
+layout(binding = 1, r8) readonly uniform image2DArray nextImg;
+#else
+layout(binding = 0, rgba8) readonly uniform image2DArray prevImg;
+layout(binding = 1, rgba8) readonly uniform image2DArray nextImg;
+#endif
+
+struct TrackPoint {
+    vec2  prev;     // position in the previous frame (level 0)
+    vec2  next;     // estimate in the current frame (level 0), initialized to prev
+    uint  status;   // 1 = tracked so far, 0 = lost
+    float error;    // mean |next - prev| over the window at level 0, gray levels
+};
+layout(std430, binding = 2) buffer TrackBuffer {
+    uint       count;
+    TrackPoint pts[];
+};
+
+layout(push_constant) uniform Params {
+    vec2 scale;   // level size / level-0 size
+    uint last;    // 1 on level 0: write the error
+} pc;
+
+const uint GROUP = 64u;
+shared float tI[WIN * WIN];     // template and its gradient, sampled around prev
+shared float tX[WIN * WIN];
+shared float tY[WIN * WIN];
+shared vec4 red[GROUP];
+
+float toUnit(vec4 v) {
+#if defined(INPUT_R8UI)
+    return v.r / 255.0;
+#elif defined(INPUT_R8)
+    return v.r;
+#else
+    return dot(v.rgb, vec3(0.299, 0.587, 0.114));
+#endif
+}
+
+// Bilinear sample with clamped edges; storage images have no samplers
+#define BILINEAR(name, img)                                                         \
+float name(vec2 x) {                                                                \
+    ivec2 hi = imageSize(img).xy - 1;                                               \
+    ivec2 q = ivec2(floor(x));                                                      \
+    vec2 f = x - vec2(q);                                                           \
+    float a = toUnit(vec4(imageLoad(img, ivec3(clamp(q,               ivec2(0), hi), 0)))); \
+    float b = toUnit(vec4(imageLoad(img, ivec3(clamp(q + ivec2(1, 0), ivec2(0), hi), 0)))); \
+    float c = toUnit(vec4(imageLoad(img, ivec3(clamp(q + ivec2(0, 1), ivec2(0), hi), 0)))); \
+    float d = toUnit(vec4(imageLoad(img, ivec3(clamp(q + ivec2(1, 1), ivec2(0), hi), 0)))); \
+    return mix(mix(a, b, f.x), mix(c, d, f.x), f.y);                                \
+}
+BILINEAR(samplePrev, prevImg)
+BILINEAR(sampleNext, nextImg)
+
+// Workgroup sum; the trailing barrier keeps red[] intact until everyone read it
+vec4 reduce(vec4 v) {
+    uint t = gl_LocalInvocationIndex;
+    red[t] = v;
+    barrier();
+    for (uint s = GROUP / 2u; s > 0u; s >>= 1) {
+        if (t < s) red[t] += red[t + s];
+        barrier();
+    }
+    vec4 r = red[0];
+    barrier();
+    return r;
+}
+
+void main() {
+    uint i = gl_WorkGroupID.x;
+    // Uniform exits: every invocation of the group reads the same point
+    if (i >= min(count, uint(pts.length())) || pts[i].status == 0u) return;
+    uint t = gl_LocalInvocationIndex;
+
+    // Pixel centres map as in pyrdown.comp.glsl
+    vec2 p0 = (pts[i].prev + 0.5) * pc.scale - 0.5;
+    vec2 p1 = (pts[i].next + 0.5) * pc.scale - 0.5;
+    float radius = float(WIN / 2u);
+
+    // Template, central-difference gradient and the 2x2 gradient matrix G
+    vec3 g = vec3(0.0);
+    for (uint k = t; k < WIN * WIN; k += GROUP) {
+        vec2 x = p0 + vec2(k % WIN, k / WIN) - radius;
+        float dx = 0.5 * (samplePrev(x + vec2(1, 0)) - samplePrev(x - vec2(1, 0)));
+        float dy = 0.5 * (samplePrev(x + vec2(0, 1)) - samplePrev(x - vec2(0, 1)));
+        tI[k] = samplePrev(x);
+        tX[k] = dx;
+        tY[k] = dy;
+        g += vec3(dx * dx, dx * dy, dy * dy);
+    }
+    g = reduce(vec4(g, 0.0)).xyz;
+    float det = g.x * g.z - g.y * g.y;
+    float minEig = 0.5 * (g.x + g.z - sqrt((g.x - g.z) * (g.x - g.z) + 4.0 * g.y * g.y)) / float(WIN * WIN);
+    if (minEig < MIN_EIGEN || det < 1e-12) {
+        // Flat or one-dimensional texture: coarser levels keep the estimate as it
+        // is, level 0 loses the point (as OpenCV)
+        if (t == 0u && pc.last == 1u) pts[i].status = 0u;
+        return;
+    }
+
+    // Gauss-Newton on the window residual; the template gradient stays fixed
+    for (uint it = 0u; it < ITERATIONS; ++it) {
+        vec2 b = vec2(0.0);
+        for (uint k = t; k < WIN * WIN; k += GROUP) {
+            vec2 x = p1 + vec2(k % WIN, k / WIN) - radius;
+            b += (sampleNext(x) - tI[k]) * vec2(tX[k], tY[k]);
+        }
+        b = reduce(vec4(b, 0.0, 0.0)).xy;
+        vec2 delta = vec2(g.y * b.y - g.z * b.x, g.y * b.x - g.x * b.y) / det;
+        p1 += delta;
+        if (dot(delta, delta) < EPSILON * EPSILON) break;
+    }
+
+    vec2 size = vec2(imageSize(nextImg).xy);
+    bool inside = all(greaterThanEqual(p1, vec2(0.0))) && all(lessThanEqual(p1, size - 1.0));
+    float err = 0.0;
+    if (pc.last == 1u && inside) {
+        float e = 0.0;
+        for (uint k = t; k < WIN * WIN; k += GROUP) {
+            e += abs(sampleNext(p1 + vec2(k % WIN, k / WIN) - radius) - tI[k]);
+        }
+        err = reduce(vec4(e, 0.0, 0.0, 0.0)).x * 255.0 / float(WIN * WIN);
+    }
+    if (t == 0u) {
+        pts[i].next = (p1 + 0.5) / pc.scale - 0.5;
+        pts[i].status = (inside || pc.last == 0u) ? 1u : 0u;   // leaving the image only counts on level 0
+        pts[i].error = err;
+    }
+}
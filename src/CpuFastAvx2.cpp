@@ -0,0 +1,33 @@
+// AVX2 segment test; this file alone is built with -mavx2 and is only called
+// after CpuFastDetector checked the CPU at run time
+#include "CpuFastKernel.h"
+#include <immintrin.h>
+
+namespace cpufast {
+namespace {
+
+struct Avx2 {
+    using reg = __m256i;
+    static constexpr int lanes = 32;
+    static reg load(const uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(uint8_t* p, reg a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a); }
+    static reg set1(uint8_t v) { return _mm256_set1_epi8(char(v)); }
+    static reg adds(reg a, reg b) { return _mm256_adds_epu8(a, b); }
+    static reg subs(reg a, reg b) { return _mm256_subs_epu8(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_epi8(a, b); }
+    static reg and_(reg a, reg b) { return _mm256_and_si256(a, b); }
+    static reg or_(reg a, reg b) { return _mm256_or_si256(a, b); }
+    static reg gt(reg a, reg b) {   // unsigned a > b
+        const reg s = set1(0x80);
+        return _mm256_cmpgt_epi8(_mm256_xor_si256(a, s), _mm256_xor_si256(b, s));
+    }
+    static bool any(reg a) { return _mm256_movemask_epi8(a) != 0; }
+};
+
+} // namespace
+
+int segmentTestRowAvx2(const uint8_t* row, const Circle& c, int& x, int x1, int* xs) {
+    return segmentTestRow<Avx2>(row, c, x, x1, xs);
+}
+
+} // namespace cpufast
@@ -0,0 +1,376 @@
+#include "CpuFastDetector.h"
+#include "CpuFastKernel.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <cmath>
+#include <cstddef>
+
+// Baseline vectors of the target; AVX2 is a separately built kernel (CPU_FAST_AVX2)
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// --- Segment test (must match comp.comp.glsl) --------------------------------
+
+constexpr int kBorder = int(kFastBorder);
+constexpr int kCircle16[16][2] = {
+    { 0,-3}, { 1,-3}, { 2,-2}, { 3,-1},
+    { 3, 0}, { 3, 1}, { 2, 2}, { 1, 3},
+    { 0, 3}, {-1, 3}, {-2, 2}, {-3, 1},
+    {-3, 0}, {-3,-1}, {-2,-2}, {-1,-3}
+};
+constexpr int kCircle12[12][2] = {
+    { 0,-2}, { 1,-2}, { 2,-1}, { 2, 0},
+    { 2, 1}, { 1, 2}, { 0, 2}, {-1, 2},
+    {-2, 1}, {-2, 0}, {-2,-1}, {-1,-2}
+};
+constexpr int kCircle8[8][2] = {
+    { 0,-1}, { 1,-1}, { 1, 0}, { 1, 1},
+    { 0, 1}, {-1, 1}, {-1, 0}, {-1,-1}
+};
+
+using cpufast::Circle;
+
+Circle makeCircle(FastPattern pattern, uint32_t threshold, size_t step) {
+    const FastPatternInfo info = fastPatternInfo(pattern);
+    const int (*table)[2] = info.circle == 16 ? kCircle16 : info.circle == 12 ? kCircle12 : kCircle8;
+    Circle c{};
+    c.n = int(info.circle);
+    c.arc = int(info.arc);
+    c.step = c.n / 4;
+    c.compassMin = c.arc / c.step;
+    c.threshold = int(threshold);
+    for (int i = 0; i < c.n; ++i) c.off[i] = ptrdiff_t(table[i][1]) * ptrdiff_t(step) + table[i][0];
+    return c;
+}
+
+bool hasArc(uint32_t mask, const Circle& c) {
+    uint32_t m = mask | (mask << c.n);
+    uint32_t run = m;
+    for (int i = 1; i < c.arc; ++i) run &= m >> i;
+    return run != 0;
+}
+
+// Strict comparisons, as cv::FAST: brighter means I > I0 + t
+bool segmentTest(const uint8_t* p, const Circle& c) {
+    const int I0 = p[0], hi = I0 + c.threshold, lo = I0 - c.threshold;
+    uint32_t bright = 0, dark = 0;
+    int nb = 0, nd = 0;
+    for (int i = 0; i < c.n; i += c.step) {
+        const int Ii = p[c.off[i]];
+        if (Ii > hi) { bright |= 1u << i; ++nb; }
+        if (Ii < lo) { dark   |= 1u << i; ++nd; }
+    }
+    if (nb < c.compassMin && nd < c.compassMin) return false;
+    for (int i = 0; i < c.n; ++i) {
+        if (i % c.step == 0) continue;
+        const int Ii = p[c.off[i]];
+        if (Ii > hi) bright |= 1u << i;
+        if (Ii < lo) dark   |= 1u << i;
+    }
+    return hasArc(bright, c) || hasArc(dark, c);
+}
+
+// Best arc by its weakest difference; corners have score > threshold (cornerScore in the shader)
+int cornerScore(const uint8_t* p, const Circle& c) {
+    int d[16];
+    for (int i = 0; i < c.n; ++i) d[i] = int(p[c.off[i]]) - int(p[0]);
+    int best = 0;
+    for (int s = 0; s < c.n; ++s) {
+        int mn = d[s], mx = d[s];
+        for (int k = 1; k < c.arc; ++k) {
+            const int v = d[(s + k) % c.n];
+            mn = std::min(mn, v);
+            mx = std::max(mx, v);
+        }
+        best = std::max(best, std::max(mn, -mx));
+    }
+    return best;
+}
+
+// --- SIMD lanes ---------------------------------------------------------------
+// Byte-wise compare masks (0xFF / 0x00) over `lanes` consecutive pixels.
+
+#if defined(__SSE2__) || defined(_M_X64)
+struct Sse2 {
+    using reg = __m128i;
+    static constexpr int lanes = 16;
+    static reg load(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(uint8_t* p, reg a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a); }
+    static reg set1(uint8_t v) { return _mm_set1_epi8(char(v)); }
+    static reg adds(reg a, reg b) { return _mm_adds_epu8(a, b); }
+    static reg subs(reg a, reg b) { return _mm_subs_epu8(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_epi8(a, b); }
+    static reg and_(reg a, reg b) { return _mm_and_si128(a, b); }
+    static reg or_(reg a, reg b) { return _mm_or_si128(a, b); }
+    static reg gt(reg a, reg b) {   // unsigned a > b
+        const reg s = set1(0x80);
+        return _mm_cmpgt_epi8(_mm_xor_si128(a, s), _mm_xor_si128(b, s));
+    }
+    static bool any(reg a) { return _mm_movemask_epi8(a) != 0; }
+};
+#elif defined(__ARM_NEON)
+struct Neon {
+    using reg = uint8x16_t;
+    static constexpr int lanes = 16;
+    static reg load(const uint8_t* p) { return vld1q_u8(p); }
+    static void store(uint8_t* p, reg a) { vst1q_u8(p, a); }
+    static reg set1(uint8_t v) { return vdupq_n_u8(v); }
+    static reg adds(reg a, reg b) { return vqaddq_u8(a, b); }
+    static reg subs(reg a, reg b) { return vqsubq_u8(a, b); }
+    static reg sub(reg a, reg b) { return vsubq_u8(a, b); }
+    static reg and_(reg a, reg b) { return vandq_u8(a, b); }
+    static reg or_(reg a, reg b) { return vorrq_u8(a, b); }
+    static reg gt(reg a, reg b) { return vcgtq_u8(a, b); }
+    static bool any(reg a) {
+        uint64x2_t w = vreinterpretq_u64_u8(a);
+        return (vgetq_lane_u64(w, 0) | vgetq_lane_u64(w, 1)) != 0;
+    }
+};
+#endif
+
+struct SimdPath {
+    const char* name;
+    cpufast::RowKernel kernel;   // nullptr = scalar only
+};
+
+// Segment-test paths this CPU can run, best first
+std::vector<SimdPath> availablePaths() {
+    std::vector<SimdPath> paths;
+#ifdef CPU_FAST_AVX2
+    if (__builtin_cpu_supports("avx2")) paths.push_back({"avx2", cpufast::segmentTestRowAvx2});
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    paths.push_back({"sse2", cpufast::segmentTestRow<Sse2>});
+#elif defined(__ARM_NEON)
+    paths.push_back({"neon", cpufast::segmentTestRow<Neon>});
+#endif
+    paths.push_back({"scalar", nullptr});
+    return paths;
+}
+
+// Calls emit(x, score) for every corner in [x0, x1) of `row`, left to right:
+// the vector kernel over whole vectors, the scalar test for the rest. `xs`
+// holds at least x1 - x0 entries. The caller guarantees the whole circle of
+// every tested pixel is inside the image.
+template <class Emit>
+void scanRow(const uint8_t* row, const Circle& c, int x0, int x1, cpufast::RowKernel kernel, int* xs, Emit&& emit) {
+    int x = x0;
+    if (kernel) {
+        const int n = kernel(row, c, x, x1, xs);
+        for (int i = 0; i < n; ++i) emit(xs[i], cornerScore(row + xs[i], c));
+    }
+    for (; x < x1; ++x) {
+        if (segmentTest(row + x, c)) emit(x, cornerScore(row + x, c));
+    }
+}
+
+void clampToCapacity(std::vector<Keypoint>& kps, uint32_t capacity, bool& warned) {
+    if (kps.size() > capacity) {
+        if (!warned) {
+            std::cerr << "Keypoint buffer overflow: " << kps.size() << " found, kept " << capacity
+                      << " (reported once, raise maxKeypoints)\n";
+            warned = true;
+        }
+        kps.resize(capacity);
+    }
+}
+
+} // namespace
+
+// --- CpuFastDetector -----------------------------------------------------------
+
+CpuFastDetector::CpuFastDetector(const Options& opts)
+    : opts_(opts), pool_(opts.threads) {
+    if (opts_.pyramidLevels > 1 && !(opts_.pyramidScale > 1.0f)) {
+        throw std::runtime_error("CpuFastDetector: pyramidScale must be > 1");
+    }
+    if (opts_.threshold > 255) {
+        throw std::runtime_error("CpuFastDetector: threshold must be in [0, 255]");
+    }
+    if (opts_.pyramidLevels == 0) opts_.pyramidLevels = 1;
+    levels_.resize(opts_.pyramidLevels);
+
+    const std::vector<SimdPath> paths = availablePaths();
+    auto path = paths.begin();
+    if (!opts_.simd.empty()) {
+        path = std::find_if(paths.begin(), paths.end(), [&](const SimdPath& p) { return opts_.simd == p.name; });
+        if (path == paths.end()) throw std::runtime_error("CpuFastDetector: segment test '" + opts_.simd + "' is not available");
+    }
+    simd_ = path->name;
+    kernel_ = path->kernel;
+}
+
+void CpuFastDetector::setThreshold(uint32_t threshold) {
+    opts_.threshold = std::min(threshold, 255u);
+}
+
+std::vector<std::string> CpuFastDetector::simdPaths() {
+    std::vector<std::string> names;
+    for (const SimdPath& p : availablePaths()) names.push_back(p.name);
+    return names;
+}
+
+float CpuFastDetector::levelScale(uint32_t level) const {
+    return std::pow(opts_.pyramidScale, float(level));
+}
+
+std::vector<Keypoint> CpuFastDetector::detect(const cv::Mat& frame) {
+    if (frame.empty()) throw std::runtime_error("CpuFastDetector::detect: empty frame");
+    std::vector<Keypoint> kps;
+    detectImage(frame, 0, kps);
+    clampToCapacity(kps, opts_.maxKeypoints, overflowWarned_);
+    return kps;
+}
+
+std::vector<std::vector<Keypoint>> CpuFastDetector::detectBatch(const std::vector<cv::Mat>& frames) {
+    if (frames.empty() || frames[0].empty()) throw std::runtime_error("CpuFastDetector::detectBatch: empty frame");
+    for (const cv::Mat& m : frames) {
+        if (m.cols != frames[0].cols || m.rows != frames[0].rows || m.type() != frames[0].type())
+            throw std::runtime_error("CpuFastDetector::detectBatch: all frames must have the same size and type");
+    }
+
+    std::vector<Keypoint> all;
+    for (uint32_t l = 0; l < frames.size(); ++l) detectImage(frames[l], l, all);
+    clampToCapacity(all, opts_.maxKeypoints, overflowWarned_);
+
+    std::vector<std::vector<Keypoint>> perImage(frames.size());
+    for (const Keypoint& kp : all) perImage[kp.layer].push_back(kp);
+    return perImage;
+}
+
+void CpuFastDetector::detectImage(const cv::Mat& frame, uint32_t layer, std::vector<Keypoint>& out) {
+    // Converted into a scratch image: levels_[0] may still alias the caller's previous frame
+    if (frame.type() == CV_8UC3) { cv::cvtColor(frame, gray_, cv::COLOR_BGR2GRAY); levels_[0] = gray_; }
+    else if (frame.type() == CV_8UC1) levels_[0] = frame;
+    else throw std::runtime_error("CpuFastDetector: expected an 8-bit grayscale or BGR frame");
+
+    // Same level sizes as FastDetector::createResources
+    const int width = levels_[0].cols, height = levels_[0].rows;
+    for (uint32_t l = 0; l < levels_.size(); ++l) {
+        if (l > 0) {
+            const float s = levelScale(l);
+            const int lw = int(float(width) / s + 0.5f), lh = int(float(height) / s + 0.5f);
+            if (lw <= 2 * kBorder || lh <= 2 * kBorder) break;
+            levels_[l].create(lh, lw, CV_8UC1);
+            downsample(levels_[l - 1], levels_[l]);
+        }
+        detectLevel(levels_[l], layer, l, out);
+    }
+}
+
+// Bilinear resample at the destination pixel centre, as in pyrdown.comp.glsl
+void CpuFastDetector::downsample(const cv::Mat& src, cv::Mat& dst) {
+    const int sw = src.cols, sh = src.rows, dw = dst.cols, dh = dst.rows;
+    auto load = [&](int x, int y) {
+        return float(src.at<uint8_t>(std::min(std::max(y, 0), sh - 1), std::min(std::max(x, 0), sw - 1)));
+    };
+    auto mix = [](float a, float b, float t) { return a * (1.0f - t) + b * t; };
+    pool_.parallelFor(size_t(dh), [&](size_t yi) {
+        const int y = int(yi);
+        const float sy = (float(y) + 0.5f) * float(sh) / float(dh) - 0.5f;
+        const int qy = int(std::floor(sy));
+        const float fy = sy - float(qy);
+        uint8_t* out = dst.ptr<uint8_t>(y);
+        for (int x = 0; x < dw; ++x) {
+            const float sx = (float(x) + 0.5f) * float(sw) / float(dw) - 0.5f;
+            const int qx = int(std::floor(sx));
+            const float fx = sx - float(qx);
+            const float top = mix(load(qx, qy),     load(qx + 1, qy),     fx);
+            const float bot = mix(load(qx, qy + 1), load(qx + 1, qy + 1), fx);
+            out[x] = uint8_t(mix(top, bot, fy) + 0.5f);
+        }
+    });
+}
+
+void CpuFastDetector::detectLevel(const cv::Mat& img, uint32_t layer, uint32_t level, std::vector<Keypoint>& out) {
+    const int w = img.cols, h = img.rows;
+    if (w <= 2 * kBorder || h <= 2 * kBorder) return;
+    const Circle c = makeCircle(opts_.pattern, opts_.threshold, img.step);
+    const bool useScores = opts_.nonmaxSuppression || opts_.gridCell > 0;
+
+    // A few row strips per thread so uneven corner density balances out
+    const size_t rows = size_t(h - 2 * kBorder);
+    const size_t strips = std::min(rows, size_t(pool_.size()) * 4);
+    std::vector<std::vector<Keypoint>> parts(strips);
+    if (useScores) scores_.assign(size_t(w) * h, -1);
+
+    pool_.parallelFor(strips, [&](size_t s) {
+        const int y0 = kBorder + int(rows * s / strips), y1 = kBorder + int(rows * (s + 1) / strips);
+        std::vector<int> xs(static_cast<size_t>(w));
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* row = img.ptr<uint8_t>(y);
+            if (useScores) {
+                int32_t* srow = scores_.data() + size_t(y) * w;
+                scanRow(row, c, kBorder, w - kBorder, kernel_, xs.data(), [&](int x, int score) { srow[x] = score; });
+            } else {
+                scanRow(row, c, kBorder, w - kBorder, kernel_, xs.data(), [&](int x, int score) {
+                    parts[s].push_back({uint32_t(x), uint32_t(y), float(score), layer, level});
+                });
+            }
+        }
+    });
+
+    if (useScores) {
+        // Score if (x, y) survives the selection rule, else -1 (nms.comp.glsl)
+        auto candidate = [&](int x, int y) -> int32_t {
+            const int32_t s = scores_[size_t(y) * w + x];
+            if (s < 0 || !opts_.nonmaxSuppression) return s;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int qx = x + dx, qy = y + dy;
+                    if ((dx == 0 && dy == 0) || qx < 0 || qy < 0 || qx >= w || qy >= h) continue;
+                    if (scores_[size_t(qy) * w + qx] >= s) return -1;
+                }
+            }
+            return s;
+        };
+
+        if (opts_.gridCell == 0) {
+            pool_.parallelFor(strips, [&](size_t s) {
+                const int y0 = kBorder + int(rows * s / strips), y1 = kBorder + int(rows * (s + 1) / strips);
+                for (int y = y0; y < y1; ++y) {
+                    for (int x = kBorder; x < w - kBorder; ++x) {
+                        const int32_t score = candidate(x, y);
+                        if (score >= 0) parts[s].push_back({uint32_t(x), uint32_t(y), float(score), layer, level});
+                    }
+                }
+            });
+        } else {
+            // Best gridTopK per cell, higher score first, ties to the lower in-cell index (grid.comp.glsl)
+            const int cell = int(opts_.gridCell);
+            const int cellsX = (w + cell - 1) / cell, cellsY = (h + cell - 1) / cell;
+            parts.assign(size_t(cellsY), {});
+            pool_.parallelFor(size_t(cellsY), [&](size_t cy) {
+                std::vector<std::pair<int32_t, uint32_t>> cand;   // (score, index within the cell)
+                for (int cx = 0; cx < cellsX; ++cx) {
+                    cand.clear();
+                    const int ox = cx * cell, oy = int(cy) * cell;
+                    for (int y = oy; y < std::min(oy + cell, h); ++y) {
+                        for (int x = ox; x < std::min(ox + cell, w); ++x) {
+                            const int32_t score = candidate(x, y);
+                            if (score >= 0) cand.push_back({score, uint32_t((y - oy) * cell + (x - ox))});
+                        }
+                    }
+                    const size_t k = std::min<size_t>(opts_.gridTopK, cand.size());
+                    std::partial_sort(cand.begin(), cand.begin() + k, cand.end(), [](const auto& a, const auto& b) {
+                        return a.first > b.first || (a.first == b.first && a.second < b.second);
+                    });
+                    for (size_t i = 0; i < k; ++i) {
+                        const uint32_t x = uint32_t(ox) + cand[i].second % uint32_t(cell);
+                        const uint32_t y = uint32_t(oy) + cand[i].second / uint32_t(cell);
+                        parts[cy].push_back({x, y, float(cand[i].first), layer, level});
+                    }
+                }
+            });
+        }
+    }
+
+    for (const auto& p : parts) out.insert(out.end(), p.begin(), p.end());
+}
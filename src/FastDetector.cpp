@@ -0,0 +1,1460 @@
+#include "FastDetector.h"
+#include "VulkanUtils.h"
+#include "ShaderLibrary.h"
+#include <opencv2/imgproc.hpp>
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <deque>
+#include <chrono>
+
+// Largest R in comp.comp.glsl (halo of the tiled kernel) and its BORDER;
+// pyramid levels without an interior are dropped
+static constexpr uint32_t kFastRadius = 3;
+
+// TrackPoint in track.comp.glsl (std430), after a uint count padded to 8 bytes
+struct TrackSlot {
+    float prevX, prevY;
+    float nextX, nextY;
+    uint32_t status;
+    float error;
+};
+static_assert(sizeof(TrackSlot) == 24, "must match the std430 TrackPoint layout");
+static constexpr VkDeviceSize kTrackHeader = 8;
+
+// TileList in tiles.comp.glsl / comp.comp.glsl: VkDispatchIndirectCommand padded to 16 bytes
+static constexpr VkDeviceSize kTileHeader = 16;
+
+// --- Lifecycle -------------------------------------------------------------
+
+FastDetector::FastDetector(const VulkanSetup& vk, const Options& opts)
+    : vk_(vk), opts_(opts), allocator_(vk.physicalDevice(), vk.device()) {
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(vk_.physicalDevice(), &props);
+    checkWorkgroup(opts_.workgroupX, opts_.workgroupY);
+    if (opts_.threshold > 255) {
+        throw std::runtime_error("FastDetector: threshold must be in [0, 255]");
+    }
+
+    if (opts_.pyramidLevels > 1 && !(opts_.pyramidScale > 1.0f)) {
+        throw std::runtime_error("FastDetector: pyramidScale must be > 1");
+    }
+    // grid.comp.glsl: CELL*CELL candidate floats + 256 (score, index) reduction slots
+    const uint64_t gridBytes = uint64_t(opts_.gridCell) * opts_.gridCell * 4 + 256 * 8;
+    if (opts_.gridCell > 0 && gridBytes > props.limits.maxComputeSharedMemorySize) {
+        throw std::runtime_error("FastDetector: gridCell " + std::to_string(opts_.gridCell) +
+                                 " exceeds the shared memory limit");
+    }
+
+    maxLayers_ = props.limits.maxImageArrayLayers;
+    storageAlignment_ = std::max<VkDeviceSize>(props.limits.minStorageBufferOffsetAlignment, kTileHeader);
+    queue_ = opts_.asyncCompute ? vk_.asyncComputeQueue() : vk_.computeQueue();
+    queueFamily_ = opts_.asyncCompute ? vk_.asyncComputeQueueFamily() : vk_.computeQueueFamily();
+    if (opts_.transferQueue && vk_.transferQueueFamily() != queueFamily_) {
+        transferQueue_ = vk_.transferQueue();
+        transferFamily_ = vk_.transferQueueFamily();
+    }
+    if (opts_.telemetry) opts_.profile = true;   // the GPU stage histograms need the timestamps
+    if (opts_.profile) {
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(vk_.physicalDevice(), &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(vk_.physicalDevice(), &familyCount, families.data());
+        const uint32_t bits = families[queueFamily_].timestampValidBits;
+        if (bits > 0) {
+            timestampPeriod_ = props.limits.timestampPeriod;
+            timestampMask_ = bits >= 64 ? ~0ull : ((1ull << bits) - 1);
+        } else {
+            std::cerr << "Compute queue has no timestamps, profiling host stages only" << std::endl;
+        }
+    }
+    if (opts_.maxTrackPoints > 0) {
+        // track.comp.glsl: template + gradients (3 floats per window pixel) + 64 vec4 reduction slots
+        const uint32_t win = opts_.trackWindow;
+        if (win < 3 || win > 31 || win % 2 == 0) {
+            throw std::runtime_error("FastDetector: trackWindow must be odd and in [3, 31]");
+        }
+        if (uint64_t(win) * win * 12 + 64 * 16 > props.limits.maxComputeSharedMemorySize) {
+            throw std::runtime_error("FastDetector: trackWindow " + std::to_string(win) +
+                                     " exceeds the shared memory limit");
+        }
+    }
+    if (opts_.framesInFlight == 0) opts_.framesInFlight = 1;
+    if (opts_.pyramidLevels == 0) opts_.pyramidLevels = 1;
+
+    chooseInputFormat();
+    if (vk_.hostImportAlignment() > 0) {
+        getHostPointerProperties_ = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+            vkGetDeviceProcAddr(vk_.device(), "vkGetMemoryHostPointerPropertiesEXT"));
+    }
+
+    VkCommandPoolCreateInfo poolCI{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    poolCI.queueFamilyIndex = queueFamily_;
+    poolCI.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    VK_CHECK(vkCreateCommandPool(vk_.device(), &poolCI, nullptr, &cmdPool_), "vkCreateCommandPool");
+    if (transferQueue_ != VK_NULL_HANDLE) {
+        poolCI.queueFamilyIndex = transferFamily_;
+        VK_CHECK(vkCreateCommandPool(vk_.device(), &poolCI, nullptr, &transferPool_), "vkCreateCommandPool");
+    }
+
+    createDescriptors();
+    pipelineCache_ = std::make_unique<PipelineCache>(vk_, opts_.pipelineCache);
+    createPipelines();
+    pipelineCache_->save();   // persist right away, workers may not exit cleanly
+
+    frames_.resize(slotCount());
+    for (Frame& f : frames_) createFrame(f);
+    if (opts_.telemetry) registerMetrics();
+}
+
+FastDetector::~FastDetector() {
+    VkDevice dev = vk_.device();
+    if (dev == VK_NULL_HANDLE) return;
+    vkQueueWaitIdle(queue_);
+    if (transferQueue_ != VK_NULL_HANDLE) vkQueueWaitIdle(transferQueue_);
+
+    for (Frame& f : frames_) destroyFrame(f);
+    for (HostImport& imp : imports_) destroyImport(imp);
+    for (auto& v : fastVariants_) destroyPipeline(v.second);
+    destroyPipeline(nmsPipe_);
+    destroyPipeline(overlayPipe_);
+    destroyPipeline(pyrPipe_);
+    destroyPipeline(gridPipe_);
+    destroyPipeline(blurPipe_);
+    destroyPipeline(orbPipe_);
+    destroyPipeline(trackPipe_);
+    destroyPipeline(tilePipe_);
+    pipelineCache_.reset();
+    vkDestroyDescriptorPool(dev, descPool_, nullptr);
+    vkDestroyDescriptorSetLayout(dev, fastDsl_, nullptr);
+    vkDestroyDescriptorSetLayout(dev, nmsDsl_, nullptr);
+    vkDestroyDescriptorSetLayout(dev, overlayDsl_, nullptr);
+    vkDestroyDescriptorSetLayout(dev, pyrDsl_, nullptr);
+    vkDestroyDescriptorSetLayout(dev, orbDsl_, nullptr);
+    vkDestroyDescriptorSetLayout(dev, trackDsl_, nullptr);
+    vkDestroyDescriptorSetLayout(dev, tileDsl_, nullptr);
+    vkDestroyCommandPool(dev, cmdPool_, nullptr);
+    if (transferPool_ != VK_NULL_HANDLE) vkDestroyCommandPool(dev, transferPool_, nullptr);
+}
+
+// --- Setup -----------------------------------------------------------------
+
+void FastDetector::chooseInputFormat() {
+    inputFormat_ = opts_.inputFormat;
+    if (inputFormat_ != InputFormat::RGBA8) {
+        VkFormat f = (inputFormat_ == InputFormat::R8UInt) ? VK_FORMAT_R8_UINT : VK_FORMAT_R8_UNORM;
+        VkFormatProperties fp{};
+        vkGetPhysicalDeviceFormatProperties(vk_.physicalDevice(), f, &fp);
+        if (!vk_.enabledFeatures().shaderStorageImageExtendedFormats ||
+            !(fp.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+            std::cerr << "Single-channel storage images not supported, falling back to rgba8" << std::endl;
+            inputFormat_ = InputFormat::RGBA8;
+        }
+    }
+
+    switch (inputFormat_) {
+    case InputFormat::R8UInt:  format_ = VK_FORMAT_R8_UINT;        bytesPerPixel_ = 1; shaderSuffix_ = "_r8ui"; break;
+    case InputFormat::R8UNorm: format_ = VK_FORMAT_R8_UNORM;       bytesPerPixel_ = 1; shaderSuffix_ = "_r8";   break;
+    case InputFormat::RGBA8:   format_ = VK_FORMAT_R8G8B8A8_UNORM; bytesPerPixel_ = 4; shaderSuffix_ = "";      break;
+    }
+}
+
+void FastDetector::createDescriptors() {
+    // fast = {0: in, 1: keypoints, 2: score, 3: tile list}, nms = {0: score, 1: keypoints},
+    // overlay = {0: in, 1: out, 2: keypoints}, pyrdown / blur = {0: src level, 1: dst level},
+    // orb = {0: level, 1: smoothed level, 2: keypoints, 3: descriptors, 4: angles},
+    // track = {0: previous frame's level, 1: level, 2: track points}, tiles = {0: tile mask, 1: tile list}
+    auto binding = [](uint32_t b, VkDescriptorType t) {
+        VkDescriptorSetLayoutBinding lb{};
+        lb.binding = b; lb.descriptorType = t; lb.descriptorCount = 1; lb.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        return lb;
+    };
+    auto makeLayout = [&](const std::vector<VkDescriptorSetLayoutBinding>& bindings, VkDescriptorSetLayout& dsl) {
+        VkDescriptorSetLayoutCreateInfo dlci{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+        dlci.bindingCount = static_cast<uint32_t>(bindings.size()); dlci.pBindings = bindings.data();
+        VK_CHECK(vkCreateDescriptorSetLayout(vk_.device(), &dlci, nullptr, &dsl), "vkCreateDescriptorSetLayout");
+    };
+    makeLayout({binding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE), binding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+                binding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE), binding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)}, fastDsl_);
+    makeLayout({binding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE), binding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)}, nmsDsl_);
+    makeLayout({binding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE), binding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
+                binding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)}, overlayDsl_);
+    makeLayout({binding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE), binding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)}, pyrDsl_);
+    makeLayout({binding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE), binding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
+                binding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER), binding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+                binding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)}, orbDsl_);
+    makeLayout({binding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE), binding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE),
+                binding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)}, trackDsl_);
+    makeLayout({binding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER), binding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)}, tileDsl_);
+
+    // Per frame slot: fast + nms + pyrdown (+ blur + orb) (+ tiles) (+ track) sets per level, plus one overlay set
+    const uint32_t n = slotCount(), l = opts_.pyramidLevels, o = opts_.orb ? 1 : 0, t = opts_.maxTrackPoints > 0 ? 1 : 0;
+    const uint32_t m = opts_.tileMask ? 1 : 0;
+    VkDescriptorPoolSize poolSizes[2] = {{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, ((5 + 4 * o + 2 * t) * l + 2) * n},
+                                         {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, ((3 + 3 * o + t + 2 * m) * l + 1) * n}};
+    VkDescriptorPoolCreateInfo dpci{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    dpci.poolSizeCount = 2; dpci.pPoolSizes = poolSizes; dpci.maxSets = ((3 + 2 * o + t + m) * l + 1) * n;
+    VK_CHECK(vkCreateDescriptorPool(vk_.device(), &dpci, nullptr, &descPool_), "vkCreateDescriptorPool");
+}
+
+void FastDetector::checkWorkgroup(uint32_t wx, uint32_t wy) const {
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(vk_.physicalDevice(), &props);
+    const uint64_t tileBytes = uint64_t(wx + 2 * kFastRadius) * (wy + 2 * kFastRadius) * 4;
+    if (wx == 0 || wy == 0 || uint64_t(wx) * wy > props.limits.maxComputeWorkGroupInvocations ||
+        wx > props.limits.maxComputeWorkGroupSize[0] || wy > props.limits.maxComputeWorkGroupSize[1] ||
+        (opts_.tiled && tileBytes > props.limits.maxComputeSharedMemorySize)) {
+        throw std::runtime_error("FastDetector: workgroup " + std::to_string(wx) + "x" + std::to_string(wy) +
+                                 " exceeds device limits");
+    }
+}
+
+void FastDetector::selectFastPipeline() {
+    const auto key = std::make_tuple(opts_.pattern, opts_.workgroupX, opts_.workgroupY);
+    auto it = fastVariants_.find(key);
+    if (it == fastVariants_.end()) {
+        // Specialization constants 0/1 = local_size_x/y, 2 = WRITE_SCORES, 3/4 = CIRCLE/ARC, 5 = TILE_LIST
+        const FastPatternInfo pattern = fastPatternInfo(opts_.pattern);
+        const uint32_t specData[6] = {opts_.workgroupX, opts_.workgroupY, VkBool32(writeScores() ? VK_TRUE : VK_FALSE),
+                                      pattern.circle, pattern.arc, VkBool32(opts_.tileMask ? VK_TRUE : VK_FALSE)};
+        VkSpecializationMapEntry specEntries[6];
+        for (uint32_t i = 0; i < 6; ++i) specEntries[i] = {i, i * uint32_t(sizeof(uint32_t)), sizeof(uint32_t)};
+        VkSpecializationInfo spec{6, specEntries, sizeof(specData), specData};
+
+        Pipeline p;
+        createPipeline(p, std::string(opts_.tiled ? "comp_tiled" : "comp") + shaderSuffix_ + ".spv",
+                       fastDsl_, 2 * sizeof(uint32_t), &spec);
+        it = fastVariants_.emplace(key, p).first;
+        pipelineCache_->save();
+    }
+    fastPipe_ = &it->second;
+}
+
+void FastDetector::setThreshold(uint32_t threshold) {
+    opts_.threshold = std::min(threshold, 255u);
+}
+
+void FastDetector::setPattern(FastPattern pattern) {
+    opts_.pattern = pattern;
+    selectFastPipeline();
+}
+
+void FastDetector::setWorkgroupSize(uint32_t x, uint32_t y) {
+    checkWorkgroup(x, y);
+    opts_.workgroupX = x;
+    opts_.workgroupY = y;
+    selectFastPipeline();
+}
+
+void FastDetector::createPipelines() {
+    // fast takes {level, threshold} as push constants, nms the level, overlay {drawRings, levelScale}
+    selectFastPipeline();
+    if (opts_.gridCell > 0) {
+        // The grid pass applies the NMS rule itself; constants 0 = CELL, 1 = NMS
+        const uint32_t gridSpecData[2] = {opts_.gridCell, VkBool32(opts_.nonmaxSuppression ? VK_TRUE : VK_FALSE)};
+        const VkSpecializationMapEntry gridSpecEntries[2] = {{0, 0, sizeof(uint32_t)}, {1, sizeof(uint32_t), sizeof(VkBool32)}};
+        VkSpecializationInfo gridSpec{2, gridSpecEntries, sizeof(gridSpecData), gridSpecData};
+        createPipeline(gridPipe_, "grid.spv", nmsDsl_, 2 * sizeof(uint32_t), &gridSpec);
+    } else if (opts_.nonmaxSuppression) {
+        createPipeline(nmsPipe_, "nms.spv", nmsDsl_, sizeof(uint32_t), nullptr);
+    }
+    if (opts_.debugOverlay) {
+        createPipeline(overlayPipe_, "overlay" + shaderSuffix_ + ".spv", overlayDsl_, 2 * sizeof(uint32_t), nullptr);
+    }
+    if (opts_.pyramidLevels > 1) {
+        createPipeline(pyrPipe_, "pyrdown" + shaderSuffix_ + ".spv", pyrDsl_, 0, nullptr);
+    }
+    if (opts_.orb) {
+        createPipeline(blurPipe_, "blur" + shaderSuffix_ + ".spv", pyrDsl_, 0, nullptr);
+        createPipeline(orbPipe_, "orb" + shaderSuffix_ + ".spv", orbDsl_, sizeof(uint32_t), nullptr);
+    }
+    if (opts_.maxTrackPoints > 0) {
+        // Constants 0 = WIN, 1 = ITERATIONS, 2 = EPSILON, 3 = MIN_EIGEN; push constants {scale, last}
+        struct { uint32_t win, iterations; float epsilon, minEigen; } trackSpecData{
+            opts_.trackWindow, opts_.trackIterations, opts_.trackEpsilon, opts_.trackMinEigen};
+        VkSpecializationMapEntry trackSpecEntries[4];
+        for (uint32_t i = 0; i < 4; ++i) trackSpecEntries[i] = {i, i * uint32_t(sizeof(uint32_t)), sizeof(uint32_t)};
+        VkSpecializationInfo trackSpec{4, trackSpecEntries, sizeof(trackSpecData), &trackSpecData};
+        createPipeline(trackPipe_, "track" + shaderSuffix_ + ".spv", trackDsl_, 3 * sizeof(uint32_t), &trackSpec);
+    }
+    if (opts_.tileMask) {
+        // Push constants {levelTiles, grid, scale}
+        createPipeline(tilePipe_, "tiles.spv", tileDsl_, 6 * sizeof(uint32_t), nullptr);
+    }
+}
+
+void FastDetector::createFrame(Frame& f) {
+    VkCommandBufferAllocateInfo cbi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    cbi.commandPool = cmdPool_; cbi.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; cbi.commandBufferCount = 1;
+    VK_CHECK(vkAllocateCommandBuffers(vk_.device(), &cbi, &f.cmd), "vkAllocateCommandBuffers");
+
+    VkFenceCreateInfo fci{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+    VK_CHECK(vkCreateFence(vk_.device(), &fci, nullptr, &f.fence), "vkCreateFence");
+    if (transferQueue_ != VK_NULL_HANDLE) {
+        cbi.commandPool = transferPool_;
+        VK_CHECK(vkAllocateCommandBuffers(vk_.device(), &cbi, &f.uploadCmd), "vkAllocateCommandBuffers");
+        VkSemaphoreCreateInfo sci{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+        VK_CHECK(vkCreateSemaphore(vk_.device(), &sci, nullptr, &f.uploaded), "vkCreateSemaphore");
+    }
+
+    // Sets are allocated once for the maximum number of levels, images are bound per size
+    f.levels.resize(opts_.pyramidLevels);
+    std::vector<VkDescriptorSetLayout> layouts;
+    const bool track = opts_.maxTrackPoints > 0;
+    const size_t perLevel = 3 + (opts_.orb ? 2 : 0) + (opts_.tileMask ? 1 : 0) + (track ? 1 : 0);
+    for (size_t l = 0; l < f.levels.size(); ++l) {
+        layouts.insert(layouts.end(), {fastDsl_, nmsDsl_, pyrDsl_});
+        if (opts_.orb) layouts.insert(layouts.end(), {pyrDsl_, orbDsl_});
+        if (opts_.tileMask) layouts.push_back(tileDsl_);
+        if (track) layouts.push_back(trackDsl_);
+    }
+    layouts.push_back(overlayDsl_);
+    std::vector<VkDescriptorSet> sets(layouts.size());
+    VkDescriptorSetAllocateInfo dsai{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    dsai.descriptorPool = descPool_; dsai.descriptorSetCount = uint32_t(layouts.size()); dsai.pSetLayouts = layouts.data();
+    VK_CHECK(vkAllocateDescriptorSets(vk_.device(), &dsai, sets.data()), "vkAllocateDescriptorSets");
+    for (size_t l = 0; l < f.levels.size(); ++l) {
+        f.levels[l].fastSet = sets[perLevel * l];
+        f.levels[l].nmsSet = sets[perLevel * l + 1];
+        f.levels[l].pyrSet = sets[perLevel * l + 2];
+        if (opts_.orb) {
+            f.levels[l].blurSet = sets[perLevel * l + 3];
+            f.levels[l].orbSet = sets[perLevel * l + 4];
+        }
+        if (opts_.tileMask) f.levels[l].tileSet = sets[perLevel * l + (opts_.orb ? 5 : 3)];
+        if (track) f.levels[l].trackSet = sets[perLevel * (l + 1) - 1];
+    }
+    f.overlaySet = sets.back();
+
+    if (hasGpuTimestamps()) {
+        VkQueryPoolCreateInfo qci{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+        qci.queryType = VK_QUERY_TYPE_TIMESTAMP; qci.queryCount = kStampCount;
+        VK_CHECK(vkCreateQueryPool(vk_.device(), &qci, nullptr, &f.queries), "vkCreateQueryPool");
+    }
+
+    // Host-visible so only count * sizeof(Keypoint) bytes are ever read back
+    createBuffer(f.keypoints, sizeof(uint32_t) + VkDeviceSize(opts_.maxKeypoints) * sizeof(Keypoint),
+                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (opts_.orb) {
+        createBuffer(f.descriptors, VkDeviceSize(opts_.maxKeypoints) * 32, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        createBuffer(f.angles, VkDeviceSize(opts_.maxKeypoints) * sizeof(float), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    }
+    if (track) {
+        // Written by the host before every submit and read back after it
+        createBuffer(f.track, kTrackHeader + VkDeviceSize(opts_.maxTrackPoints) * sizeof(TrackSlot),
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    }
+}
+
+void FastDetector::destroyFrame(Frame& f) {
+    destroyResources(f);
+    destroyBuffer(f.keypoints);
+    destroyBuffer(f.descriptors);
+    destroyBuffer(f.angles);
+    destroyBuffer(f.track);
+    destroyImport(f.hostImport);
+    if (f.fence != VK_NULL_HANDLE) vkDestroyFence(vk_.device(), f.fence, nullptr);
+    if (f.queries != VK_NULL_HANDLE) vkDestroyQueryPool(vk_.device(), f.queries, nullptr);
+    if (f.cmd != VK_NULL_HANDLE) vkFreeCommandBuffers(vk_.device(), cmdPool_, 1, &f.cmd);
+    if (f.uploadCmd != VK_NULL_HANDLE) vkFreeCommandBuffers(vk_.device(), transferPool_, 1, &f.uploadCmd);
+    if (f.uploaded != VK_NULL_HANDLE) vkDestroySemaphore(vk_.device(), f.uploaded, nullptr);
+    f = Frame{};
+}
+
+void FastDetector::createResources(Frame& f, uint32_t width, uint32_t height, uint32_t layers) {
+    f.width = width;
+    f.height = height;
+    f.layers = layers;
+    f.generation = ++generation_;
+    // Staging and readback hold the layers back to back, as vkCmdCopy*Image expects
+    const VkDeviceSize imageSize = VkDeviceSize(width) * height * layers * bytesPerPixel_;
+
+    // Level sizes shrink by pyramidScale; levels too small for the FAST circle are dropped
+    f.levelCount = 0;
+    for (uint32_t l = 0; l < f.levels.size(); ++l) {
+        const float s = levelScale(l);
+        const uint32_t lw = uint32_t(float(width) / s + 0.5f), lh = uint32_t(float(height) / s + 0.5f);
+        if (l > 0 && (lw <= 2 * kFastRadius || lh <= 2 * kFastRadius)) break;
+        Level& lv = f.levels[l];
+        lv.width = lw; lv.height = lh;
+        createImage(lv.image, format_, lw, lh, layers);
+        // 1x1 placeholder without NMS/grid: the score binding exists but is never touched
+        if (writeScores()) createImage(lv.score, VK_FORMAT_R32_SFLOAT, lw, lh, layers);
+        else createImage(lv.score, VK_FORMAT_R32_SFLOAT, 1, 1);
+        if (opts_.orb) createImage(lv.smooth, VK_FORMAT_R32_SFLOAT, lw, lh, layers);
+        ++f.levelCount;
+    }
+    createBuffer(f.staging, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (opts_.tileMask) {
+        // Level-0 tile mask, then per level the indirect dispatch and its tile list
+        // (room for every tile); each region starts at the storage offset alignment
+        auto alignUp = [&](VkDeviceSize v) { return (v + storageAlignment_ - 1) / storageAlignment_ * storageAlignment_; };
+        const uint32_t wx = opts_.workgroupX, wy = opts_.workgroupY;
+        f.gridWorkgroupX = wx;
+        f.gridWorkgroupY = wy;
+        f.gridX = (width + wx - 1) / wx;
+        f.gridY = (height + wy - 1) / wy;
+        VkDeviceSize bytes = alignUp(VkDeviceSize(f.gridX) * f.gridY * sizeof(uint32_t));
+        for (uint32_t l = 0; l < f.levelCount; ++l) {
+            Level& lv = f.levels[l];
+            lv.tilesX = (lv.width + wx - 1) / wx;
+            lv.tilesY = (lv.height + wy - 1) / wy;
+            lv.tileOffset = bytes;
+            bytes = alignUp(bytes + kTileHeader + VkDeviceSize(lv.tilesX) * lv.tilesY * sizeof(uint32_t));
+        }
+        createBuffer(f.tiles, bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        // x is counted by tiles.comp.glsl every frame, y and z stay
+        for (uint32_t l = 0; l < f.levelCount; ++l) {
+            const uint32_t dispatch[4] = {0, 1, layers, 0};
+            std::memcpy(static_cast<uint8_t*>(f.tiles.mapped) + f.levels[l].tileOffset, dispatch, sizeof(dispatch));
+        }
+    }
+    if (opts_.debugOverlay) {
+        createImage(f.overlay, VK_FORMAT_R8G8B8A8_UNORM, width, height, layers);
+        createBuffer(f.readback, VkDeviceSize(width) * height * layers * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    }
+
+    // Everything lives in GENERAL from here on (copies and storage access both allow it)
+    std::vector<Image*> images{&f.overlay};
+    for (uint32_t l = 0; l < f.levelCount; ++l) {
+        images.insert(images.end(), {&f.levels[l].image, &f.levels[l].score, &f.levels[l].smooth});
+    }
+    VkCommandBuffer cmd = beginOneShot();
+    for (Image* img : images) {
+        if (img->image == VK_NULL_HANDLE) continue;
+        transitionImage(cmd, img->image,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+            0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT);
+    }
+    endOneShot(cmd);
+
+    writeDescriptors(f);
+    f.upload = {f.staging.buffer, 0};
+    recordCommands(f);
+}
+
+void FastDetector::destroyResources(Frame& f) {
+    for (Level& lv : f.levels) {
+        destroyImage(lv.image);
+        destroyImage(lv.score);
+        destroyImage(lv.smooth);
+        lv.width = lv.height = 0;
+        lv.tilesX = lv.tilesY = 0;
+        lv.tileOffset = 0;
+    }
+    f.levelCount = 0;
+    destroyImage(f.overlay);
+    destroyBuffer(f.staging);
+    destroyBuffer(f.readback);
+    destroyBuffer(f.tiles);
+    f.width = f.height = f.layers = 0;
+    f.gridX = f.gridY = f.gridWorkgroupX = f.gridWorkgroupY = 0;
+    f.maskVersion = 0;
+    f.hasFrame = false;
+}
+
+void FastDetector::writeDescriptors(Frame& f) {
+    auto imageInfo = [](const Image& img) {
+        VkDescriptorImageInfo info{}; info.imageView = img.view; info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        return info;
+    };
+    VkDescriptorBufferInfo kpInfo{};   kpInfo.buffer = f.keypoints.buffer;   kpInfo.offset = 0; kpInfo.range = VK_WHOLE_SIZE;
+    VkDescriptorBufferInfo descInfo{}; descInfo.buffer = f.descriptors.buffer; descInfo.offset = 0; descInfo.range = VK_WHOLE_SIZE;
+    VkDescriptorBufferInfo angleInfo{}; angleInfo.buffer = f.angles.buffer;    angleInfo.offset = 0; angleInfo.range = VK_WHOLE_SIZE;
+
+    // deque: the writes keep pointers to the infos, so they must not move
+    std::deque<VkDescriptorImageInfo> infos;
+    std::deque<VkDescriptorBufferInfo> regions;   // ranges of the tile buffer
+    std::vector<VkWriteDescriptorSet> writes;
+    auto imageWrite = [&](VkDescriptorSet set, uint32_t b, const Image& img) {
+        infos.push_back(imageInfo(img));
+        VkWriteDescriptorSet w{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        w.dstSet = set; w.dstBinding = b; w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; w.descriptorCount = 1; w.pImageInfo = &infos.back();
+        writes.push_back(w);
+    };
+    auto bufferWrite = [&](VkDescriptorSet set, uint32_t b, const VkDescriptorBufferInfo* info) {
+        VkWriteDescriptorSet w{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        w.dstSet = set; w.dstBinding = b; w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; w.descriptorCount = 1; w.pBufferInfo = info;
+        writes.push_back(w);
+    };
+    auto region = [&](VkDeviceSize offset, VkDeviceSize range) {
+        regions.push_back({f.tiles.buffer, offset, range});
+        return &regions.back();
+    };
+    const VkDescriptorBufferInfo* maskInfo =
+        opts_.tileMask ? region(0, VkDeviceSize(f.gridX) * f.gridY * sizeof(uint32_t)) : nullptr;
+
+    for (uint32_t l = 0; l < f.levelCount; ++l) {
+        const Level& lv = f.levels[l];
+        imageWrite(lv.fastSet, 0, lv.image);
+        bufferWrite(lv.fastSet, 1, &kpInfo);
+        imageWrite(lv.fastSet, 2, lv.score);
+        // Without tileMask the list binding exists but is never read
+        if (opts_.tileMask) {
+            const VkDescriptorBufferInfo* list =
+                region(lv.tileOffset, kTileHeader + VkDeviceSize(lv.tilesX) * lv.tilesY * sizeof(uint32_t));
+            bufferWrite(lv.fastSet, 3, list);
+            bufferWrite(lv.tileSet, 0, maskInfo);
+            bufferWrite(lv.tileSet, 1, list);
+        } else {
+            bufferWrite(lv.fastSet, 3, &kpInfo);
+        }
+        if (writeScores()) {
+            imageWrite(lv.nmsSet, 0, lv.score);
+            bufferWrite(lv.nmsSet, 1, &kpInfo);
+        }
+        if (l > 0) {
+            imageWrite(lv.pyrSet, 0, f.levels[l - 1].image);
+            imageWrite(lv.pyrSet, 1, lv.image);
+        }
+        if (opts_.orb) {
+            imageWrite(lv.blurSet, 0, lv.image);
+            imageWrite(lv.blurSet, 1, lv.smooth);
+            imageWrite(lv.orbSet, 0, lv.image);
+            imageWrite(lv.orbSet, 1, lv.smooth);
+            bufferWrite(lv.orbSet, 2, &kpInfo);
+            bufferWrite(lv.orbSet, 3, &descInfo);
+            bufferWrite(lv.orbSet, 4, &angleInfo);
+        }
+    }
+    if (opts_.debugOverlay) {
+        imageWrite(f.overlaySet, 0, f.levels[0].image);
+        imageWrite(f.overlaySet, 1, f.overlay);
+        bufferWrite(f.overlaySet, 2, &kpInfo);
+    }
+    vkUpdateDescriptorSets(vk_.device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    // Until a matching previous frame exists the track sets point at the slot itself
+    if (opts_.maxTrackPoints > 0) writeTrackDescriptors(f, f);
+}
+
+void FastDetector::writeTrackDescriptors(Frame& f, const Frame& prev) {
+    VkDescriptorBufferInfo trackInfo{}; trackInfo.buffer = f.track.buffer; trackInfo.offset = 0; trackInfo.range = VK_WHOLE_SIZE;
+    std::vector<VkDescriptorImageInfo> infos(2 * f.levelCount);
+    std::vector<VkWriteDescriptorSet> writes;
+    for (uint32_t l = 0; l < f.levelCount; ++l) {
+        infos[2 * l] = {VK_NULL_HANDLE, prev.levels[l].image.view, VK_IMAGE_LAYOUT_GENERAL};
+        infos[2 * l + 1] = {VK_NULL_HANDLE, f.levels[l].image.view, VK_IMAGE_LAYOUT_GENERAL};
+        for (uint32_t b = 0; b < 3; ++b) {
+            VkWriteDescriptorSet w{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            w.dstSet = f.levels[l].trackSet; w.dstBinding = b; w.descriptorCount = 1;
+            if (b < 2) { w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; w.pImageInfo = &infos[2 * l + b]; }
+            else { w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; w.pBufferInfo = &trackInfo; }
+            writes.push_back(w);
+        }
+    }
+    vkUpdateDescriptorSets(vk_.device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    f.recordedFast = VK_NULL_HANDLE;   // sets changed under the recorded command buffer
+    f.recordedTrackSource = prev.generation;
+}
+
+// --- Per-frame command buffer ------------------------------------------------
+
+void FastDetector::recordCommands(Frame& f) {
+    VkCommandBuffer cmd = f.cmd;
+    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    VK_CHECK(vkBeginCommandBuffer(cmd, &bi), "vkBeginCommandBuffer");
+
+    // Profiling: each stamp waits for everything recorded before it
+    auto stamp = [&](Stamp s) {
+        if (f.queries == VK_NULL_HANDLE) return;
+        vkCmdWriteTimestamp(cmd, s == kStampBegin ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            f.queries, s);
+    };
+    if (f.queries != VK_NULL_HANDLE) vkCmdResetQueryPool(cmd, f.queries, 0, kStampCount);
+    stamp(kStampBegin);
+
+    // Upload. No barrier against the slot's previous use: submit() only reuses a
+    // slot after its fence was waited on, and other slots own their own images.
+    VkBufferImageCopy region{};
+    region.bufferRowLength = f.upload.rowLength;
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, f.layers};
+    region.imageOffset = {0,0,0};
+    region.imageExtent = {f.width, f.height, 1};
+    VkImage input = f.levels[0].image.image;
+    if (f.uploadCmd != VK_NULL_HANDLE) {
+        // Transfer queue: the copy overwrites the whole image, so it takes the image
+        // over from the compute family by discarding (UNDEFINED) instead of a transfer
+        // back, then releases it; the acquire below completes the hand-over.
+        VkCommandBuffer up = f.uploadCmd;
+        VK_CHECK(vkBeginCommandBuffer(up, &bi), "vkBeginCommandBuffer");
+        transitionImage(up, input,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+            0, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        vkCmdCopyBufferToImage(up, f.upload.buffer, input, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+        transferImageOwnership(up, input, transferFamily_, queueFamily_,
+            VK_ACCESS_TRANSFER_WRITE_BIT, 0,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        VK_CHECK(vkEndCommandBuffer(up), "vkEndCommandBuffer");
+        // Source stage matches the semaphore wait stage in submitSlot()
+        transferImageOwnership(cmd, input, transferFamily_, queueFamily_,
+            0, VK_ACCESS_SHADER_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    } else {
+        vkCmdCopyBufferToImage(cmd, f.upload.buffer, input, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+        transitionImage(cmd, input,
+            VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+    stamp(kStampUpload);
+
+    // Pyramid: each level is resampled from the previous one
+    if (f.levelCount > 1) {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pyrPipe_.pipeline);
+        for (uint32_t l = 1; l < f.levelCount; ++l) {
+            const Level& lv = f.levels[l];
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pyrPipe_.layout, 0, 1, &lv.pyrSet, 0, nullptr);
+            vkCmdDispatch(cmd, (lv.width + 15) / 16, (lv.height + 15) / 16, f.layers); // pyrdown.comp.glsl is fixed at 16x16
+            memoryBarrier(cmd,
+                VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+    }
+
+    // Reset the keypoint counter (and the tile counters)
+    vkCmdFillBuffer(cmd, f.keypoints.buffer, 0, sizeof(uint32_t), 0);
+    bufferBarrier(cmd, f.keypoints.buffer,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    if (opts_.tileMask) {
+        for (uint32_t l = 0; l < f.levelCount; ++l) vkCmdFillBuffer(cmd, f.tiles.buffer, f.levels[l].tileOffset, sizeof(uint32_t), 0);
+        bufferBarrier(cmd, f.tiles.buffer,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+    stamp(kStampPyramid);
+
+    if (opts_.maxTrackPoints > 0) {
+        // KLT, coarsest level first; each level refines the estimate the previous
+        // one left in the track buffer. The previous frame's levels were finished
+        // by an earlier submission, whose barriers already made them visible.
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, trackPipe_.pipeline);
+        for (uint32_t l = f.levelCount; l-- > 0;) {
+            const Level& lv = f.levels[l];
+            struct { float scaleX, scaleY; uint32_t last; } pc{
+                float(lv.width) / float(f.width), float(lv.height) / float(f.height), l == 0 ? 1u : 0u};
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, trackPipe_.layout, 0, 1, &lv.trackSet, 0, nullptr);
+            vkCmdPushConstants(cmd, trackPipe_.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+            vkCmdDispatch(cmd, opts_.maxTrackPoints, 1, 1); // one workgroup per point, idle ones exit
+            bufferBarrier(cmd, f.track.buffer,
+                VK_ACCESS_SHADER_WRITE_BIT, l > 0 ? VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_HOST_READ_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, l > 0 ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_HOST_BIT);
+        }
+    }
+    stamp(kStampTrack);
+
+    if (opts_.tileMask) {
+        // Skipped tiles never write scores, so the selection pass must find -1 there
+        if (writeScores()) {
+            const VkClearColorValue notCorner{{-1.0f, 0.0f, 0.0f, 0.0f}};
+            const VkImageSubresourceRange all{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, VK_REMAINING_ARRAY_LAYERS};
+            for (uint32_t l = 0; l < f.levelCount; ++l) {
+                vkCmdClearColorImage(cmd, f.levels[l].score.image, VK_IMAGE_LAYOUT_GENERAL, &notCorner, 1, &all);
+            }
+        }
+        // Active tile list per level; its count is the x of the indirect dispatch below
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, tilePipe_.pipeline);
+        for (uint32_t l = 0; l < f.levelCount; ++l) {
+            const Level& lv = f.levels[l];
+            struct { uint32_t tilesX, tilesY, gridX, gridY; float scaleX, scaleY; } pc{
+                lv.tilesX, lv.tilesY, f.gridX, f.gridY, float(f.width) / float(lv.width), float(f.height) / float(lv.height)};
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, tilePipe_.layout, 0, 1, &lv.tileSet, 0, nullptr);
+            vkCmdPushConstants(cmd, tilePipe_.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+            vkCmdDispatch(cmd, (lv.tilesX + 7) / 8, (lv.tilesY + 7) / 8, 1); // tiles.comp.glsl is fixed at 8x8
+        }
+        memoryBarrier(cmd,
+            VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+
+    // FAST on every level (only the active tiles with tileMask); all levels append
+    // to the same keypoint list
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, fastPipe_->pipeline);
+    for (uint32_t l = 0; l < f.levelCount; ++l) {
+        const Level& lv = f.levels[l];
+        const uint32_t params[2] = {l, opts_.threshold};
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, fastPipe_->layout, 0, 1, &lv.fastSet, 0, nullptr);
+        vkCmdPushConstants(cmd, fastPipe_->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), params);
+        if (opts_.tileMask) {
+            vkCmdDispatchIndirect(cmd, f.tiles.buffer, lv.tileOffset); // {active tiles, 1, layers}
+        } else {
+            uint32_t gx = (lv.width  + opts_.workgroupX - 1) / opts_.workgroupX;
+            uint32_t gy = (lv.height + opts_.workgroupY - 1) / opts_.workgroupY;
+            vkCmdDispatch(cmd, gx, gy, f.layers);
+        }
+    }
+    stamp(kStampDetect);
+
+    if (opts_.gridCell > 0) {
+        // Scores complete -> keep the best gridTopK per cell (NMS folded in)
+        memoryBarrier(cmd,
+            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, gridPipe_.pipeline);
+        const uint32_t cell = opts_.gridCell;
+        for (uint32_t l = 0; l < f.levelCount; ++l) {
+            const Level& lv = f.levels[l];
+            const uint32_t pc[2] = {l, opts_.gridTopK};
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, gridPipe_.layout, 0, 1, &lv.nmsSet, 0, nullptr);
+            vkCmdPushConstants(cmd, gridPipe_.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), pc);
+            vkCmdDispatch(cmd, (lv.width + cell - 1) / cell, (lv.height + cell - 1) / cell, f.layers); // one workgroup per cell
+        }
+    } else if (opts_.nonmaxSuppression) {
+        // Scores complete -> suppress non-maxima and compact the survivors
+        memoryBarrier(cmd,
+            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, nmsPipe_.pipeline);
+        for (uint32_t l = 0; l < f.levelCount; ++l) {
+            const Level& lv = f.levels[l];
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, nmsPipe_.layout, 0, 1, &lv.nmsSet, 0, nullptr);
+            vkCmdPushConstants(cmd, nmsPipe_.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(l), &l);
+            vkCmdDispatch(cmd, (lv.width + 15) / 16, (lv.height + 15) / 16, f.layers); // nms.comp.glsl is fixed at 16x16
+        }
+    }
+    stamp(kStampSelect);
+
+    if (opts_.orb) {
+        // Smoothed levels for the binary tests, then one invocation per list entry
+        // once the list is final (the barrier also covers the selection writes)
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, blurPipe_.pipeline);
+        for (uint32_t l = 0; l < f.levelCount; ++l) {
+            const Level& lv = f.levels[l];
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, blurPipe_.layout, 0, 1, &lv.blurSet, 0, nullptr);
+            vkCmdDispatch(cmd, (lv.width + 15) / 16, (lv.height + 15) / 16, f.layers); // blur.comp.glsl is fixed at 16x16
+        }
+        memoryBarrier(cmd,
+            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, orbPipe_.pipeline);
+        for (uint32_t l = 0; l < f.levelCount; ++l) {
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, orbPipe_.layout, 0, 1, &f.levels[l].orbSet, 0, nullptr);
+            vkCmdPushConstants(cmd, orbPipe_.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(l), &l);
+            vkCmdDispatch(cmd, (opts_.maxKeypoints + 63) / 64, 1, 1); // orb.comp.glsl is fixed at 64
+        }
+        for (VkBuffer b : {f.descriptors.buffer, f.angles.buffer}) {
+            bufferBarrier(cmd, b,
+                VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+        }
+    }
+    stamp(kStampDescribe);
+
+    if (opts_.debugOverlay) {
+        // overlay <- input expanded to RGBA, then rings drawn on top from the keypoint list
+        transitionImage(cmd, f.overlay.image,
+            VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+            VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, overlayPipe_.pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, overlayPipe_.layout, 0, 1, &f.overlaySet, 0, nullptr);
+        struct { uint32_t drawRings; float levelScale; } pc{0, opts_.pyramidScale};
+        vkCmdPushConstants(cmd, overlayPipe_.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+        vkCmdDispatch(cmd, (f.width + 15) / 16, (f.height + 15) / 16, f.layers); // overlay.comp.glsl is fixed at 16x16
+
+        // Rings overwrite the copied pixels and read the finished keypoint list
+        memoryBarrier(cmd,
+            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        pc.drawRings = 1;
+        vkCmdPushConstants(cmd, overlayPipe_.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+        vkCmdDispatch(cmd, (opts_.maxKeypoints + 255) / 256, 1, 1);
+
+        transitionImage(cmd, f.overlay.image,
+            VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        VkBufferImageCopy r{};
+        r.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, f.layers};
+        r.imageOffset = {0,0,0};
+        r.imageExtent = {f.width, f.height, 1};
+        vkCmdCopyImageToBuffer(cmd, f.overlay.image, VK_IMAGE_LAYOUT_GENERAL, f.readback.buffer, 1, &r);
+        bufferBarrier(cmd, f.readback.buffer,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+    }
+
+    // Make the keypoint list visible to the host
+    bufferBarrier(cmd, f.keypoints.buffer,
+        VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+    stamp(kStampEnd);
+
+    VK_CHECK(vkEndCommandBuffer(cmd), "vkEndCommandBuffer");
+    f.recordedFast = fastPipe_->pipeline;
+    f.recordedThreshold = opts_.threshold;
+    f.recordedUpload = f.upload;
+}
+
+void FastDetector::uploadFrame(Frame& f, const cv::Mat& frame, uint32_t layer) {
+    // Single-channel formats take the grayscale bytes directly; only RGBA8 needs expanding
+    const cv::Mat* src = &frame;
+    if (inputFormat_ == InputFormat::RGBA8) {
+        cv::cvtColor(frame, hostScratch_, frame.channels() == 3 ? cv::COLOR_BGR2RGBA : cv::COLOR_GRAY2RGBA);
+        src = &hostScratch_;
+    } else if (frame.channels() == 3) {
+        cv::cvtColor(frame, hostScratch_, cv::COLOR_BGR2GRAY);
+        src = &hostScratch_;
+    } else if (frame.channels() != 1) {
+        throw std::runtime_error("FastDetector: expected an 8-bit grayscale or BGR frame");
+    }
+
+    const size_t rowBytes = size_t(f.width) * bytesPerPixel_;
+    uint8_t* dst = static_cast<uint8_t*>(f.staging.mapped) + size_t(layer) * rowBytes * f.height;
+    if (src->isContinuous()) {
+        std::memcpy(dst, src->data, rowBytes * f.height);
+    } else {
+        for (uint32_t y = 0; y < f.height; ++y)
+            std::memcpy(dst + y * rowBytes, src->ptr(y), rowBytes);
+    }
+}
+
+std::vector<Keypoint> FastDetector::detect(const cv::Mat& frame) {
+    if (inFlight_ != 0) throw std::runtime_error("FastDetector::detect: frames still in flight, collect() them first");
+    submit(frame);
+    return collect();
+}
+
+std::vector<std::vector<Keypoint>> FastDetector::detectBatch(const std::vector<cv::Mat>& frames) {
+    if (inFlight_ != 0) throw std::runtime_error("FastDetector::detectBatch: frames still in flight, collect() them first");
+    submitBatch(frames);
+    return collectBatch();
+}
+
+void FastDetector::submit(const cv::Mat& frame) {
+    submitBatch({frame});
+}
+
+void FastDetector::submitBatch(const std::vector<cv::Mat>& frames) {
+    if (frames.empty() || frames[0].empty()) throw std::runtime_error("FastDetector::submit: empty frame");
+    if (inFlight_ == opts_.framesInFlight) throw std::runtime_error("FastDetector::submit: all frame slots in flight");
+    const uint32_t layers = uint32_t(frames.size());
+    if (layers > maxLayers_) {
+        throw std::runtime_error("FastDetector::submitBatch: " + std::to_string(layers) +
+                                 " images exceed maxImageArrayLayers (" + std::to_string(maxLayers_) + ")");
+    }
+    for (const cv::Mat& m : frames) {
+        if (m.cols != frames[0].cols || m.rows != frames[0].rows || m.type() != frames[0].type())
+            throw std::runtime_error("FastDetector::submitBatch: all frames must have the same size and type");
+    }
+
+    Frame& f = acquireSlot(uint32_t(frames[0].cols), uint32_t(frames[0].rows), layers);
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t l = 0; l < layers; ++l) uploadFrame(f, frames[l], l);
+    f.hostUploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    submitSlot(f, {f.staging.buffer, 0});
+}
+
+void FastDetector::submitImported(const cv::Mat& frame) {
+    if (frame.empty()) throw std::runtime_error("FastDetector::submit: empty frame");
+    const VkDeviceSize align = vk_.hostImportAlignment();
+    const size_t stride = frame.step;   // bytes per row = texels per row for CV_8UC1
+    const char* reason = nullptr;
+    if (align == 0 || getHostPointerProperties_ == nullptr) reason = "VK_EXT_external_memory_host is not available";
+    else if (bytesPerPixel_ != 1) reason = "the input format is RGBA8";
+    else if (frame.type() != CV_8UC1) reason = "the frame is not 8-bit grayscale";
+    else if (reinterpret_cast<uintptr_t>(frame.data) % align != 0) reason = "the frame data is not aligned";
+
+    const HostImport* imp = nullptr;
+    if (!reason) {
+        const VkDeviceSize bytes = VkDeviceSize(stride) * (frame.rows - 1) + VkDeviceSize(frame.cols);
+        const VkDeviceSize size = (bytes + align - 1) / align * align;
+        auto reg = std::find_if(imports_.begin(), imports_.end(),
+                                [&](const HostImport& i) { return i.base == frame.data; });
+        if (reg != imports_.end()) {
+            if (reg->size >= size) imp = &*reg;
+            else reason = "the frame is larger than its registered buffer";
+        } else {
+            // Imported for this frame only; waitOldest() drops it with the slot
+            Frame& f = acquireSlot(uint32_t(frame.cols), uint32_t(frame.rows), 1);
+            if (importHostMemory(frame.data, size, f.hostImport)) imp = &f.hostImport;
+            else reason = "the driver rejected the host pointer";
+        }
+    }
+    if (reason) {
+        if (!importWarned_) {
+            std::cerr << "FastDetector::submitImported: " << reason << ", copying through staging" << std::endl;
+            importWarned_ = true;
+        }
+        submit(frame);
+        return;
+    }
+
+    Frame& f = acquireSlot(uint32_t(frame.cols), uint32_t(frame.rows), 1);
+    f.hostUploadMs = 0;
+    submitSlot(f, {imp->buffer, uint32_t(stride)});
+}
+
+cv::Mat FastDetector::stagingFrame(uint32_t width, uint32_t height) {
+    if (bytesPerPixel_ != 1) throw std::runtime_error("FastDetector::stagingFrame: needs a single-channel input format");
+    if (width == 0 || height == 0) throw std::runtime_error("FastDetector::stagingFrame: empty frame");
+    Frame& f = acquireSlot(width, height, 1);
+    staged_ = true;
+    return cv::Mat(int(height), int(width), CV_8UC1, f.staging.mapped);
+}
+
+void FastDetector::submitStaged() {
+    if (!staged_) throw std::runtime_error("FastDetector::submitStaged: no stagingFrame() pending");
+    Frame& f = frames_[next_];
+    f.hostUploadMs = 0;
+    submitSlot(f, {f.staging.buffer, 0});
+}
+
+FastDetector::Frame& FastDetector::acquireSlot(uint32_t width, uint32_t height, uint32_t layers) {
+    if (inFlight_ == opts_.framesInFlight) throw std::runtime_error("FastDetector::submit: all frame slots in flight");
+    staged_ = false;
+    // The slot is free: its last use was collected (or it was never used)
+    Frame& f = frames_[next_];
+    // The tile buffer layout follows the FAST workgroup size
+    const bool regrid = opts_.tileMask && (f.gridWorkgroupX != opts_.workgroupX || f.gridWorkgroupY != opts_.workgroupY);
+    if (width != f.width || height != f.height || layers != f.layers || regrid) {
+        destroyResources(f);
+        createResources(f, width, height, layers);
+        if (metrics_.rebuilds) metrics_.rebuilds->add();
+    }
+    return f;
+}
+
+void FastDetector::submitSlot(Frame& f, const UploadSource& upload) {
+    f.upload = upload;
+    if (opts_.maxTrackPoints > 0) prepareTracking(f);
+    if (opts_.tileMask && f.maskVersion != maskVersion_) writeTileMask(f);
+    if (f.recordedFast != fastPipe_->pipeline || f.recordedThreshold != opts_.threshold || !(f.recordedUpload == upload)) {
+        recordCommands(f);
+    }
+    staged_ = false;
+
+    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO}; si.commandBufferCount = 1; si.pCommandBuffers = &f.cmd;
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    if (f.uploadCmd != VK_NULL_HANDLE) {
+        VkSubmitInfo ti{VK_STRUCTURE_TYPE_SUBMIT_INFO}; ti.commandBufferCount = 1; ti.pCommandBuffers = &f.uploadCmd;
+        ti.signalSemaphoreCount = 1; ti.pSignalSemaphores = &f.uploaded;
+        VK_CHECK(vkQueueSubmit(transferQueue_, 1, &ti, VK_NULL_HANDLE), "vkQueueSubmit");
+        si.waitSemaphoreCount = 1; si.pWaitSemaphores = &f.uploaded; si.pWaitDstStageMask = &waitStage;
+    }
+    VK_CHECK(vkQueueSubmit(queue_, 1, &si, f.fence), "vkQueueSubmit");
+    f.submitTime = Telemetry::Clock::now();
+    f.sequence = submitted_++;
+
+    f.hasFrame = true;
+    next_ = (next_ + 1) % uint32_t(frames_.size());
+    ++inFlight_;
+    if (opts_.telemetry) {
+        metrics_.ringOccupancy->observe(inFlight_);
+        metrics_.inFlight->set(inFlight_);
+    }
+}
+
+void FastDetector::prepareTracking(Frame& f) {
+    // The previous submission sits in the slot before this one. With one slot
+    // more than may be in flight, no frame reading that slot's images can still be
+    // running when it is reused, so they hold the previous frame until this is collected.
+    const uint32_t n = uint32_t(frames_.size());
+    const Frame& prev = frames_[(next_ + n - 1) % n];
+    const bool valid = prev.hasFrame && prev.width == f.width && prev.height == f.height &&
+                       prev.layers == 1 && f.layers == 1 && prev.levelCount == f.levelCount;
+    const Frame& source = valid ? prev : f;
+    if (f.recordedTrackSource != source.generation) writeTrackDescriptors(f, source);
+
+    // Without a previous frame the points go in as lost and the shader skips them
+    f.trackCount = uint32_t(pendingTrack_.size());
+    uint8_t* base = static_cast<uint8_t*>(f.track.mapped);
+    std::memcpy(base, &f.trackCount, sizeof(uint32_t));
+    TrackSlot* slots = reinterpret_cast<TrackSlot*>(base + kTrackHeader);
+    for (uint32_t i = 0; i < f.trackCount; ++i) {
+        const cv::Point2f& p = pendingTrack_[i];
+        slots[i] = {p.x, p.y, p.x, p.y, valid ? 1u : 0u, 0.0f};
+    }
+    pendingTrack_.clear();
+}
+
+void FastDetector::writeTileMask(Frame& f) {
+    // One uint per level-0 tile; built on the host first, since the mapping may be
+    // device-local memory that is slow to read back
+    const uint32_t gx = f.gridX, gy = f.gridY;
+    std::vector<uint32_t> cells(size_t(gx) * gy, 1u);
+    if (!detectionTiles_.empty()) {
+        if (detectionTiles_.cols != int(gx) || detectionTiles_.rows != int(gy)) {
+            throw std::runtime_error("FastDetector::submit: detection tiles are " + std::to_string(detectionTiles_.cols) + "x" +
+                                     std::to_string(detectionTiles_.rows) + ", the frame has " + std::to_string(gx) + "x" +
+                                     std::to_string(gy) + " tiles");
+        }
+        for (uint32_t y = 0; y < gy; ++y) {
+            const uint8_t* row = detectionTiles_.ptr<uint8_t>(int(y));
+            for (uint32_t x = 0; x < gx; ++x) cells[size_t(y) * gx + x] = row[x] != 0 ? 1u : 0u;
+        }
+    } else if (!detectionMask_.empty()) {
+        if (detectionMask_.cols != int(f.width) || detectionMask_.rows != int(f.height)) {
+            throw std::runtime_error("FastDetector::submit: the detection mask does not match the frame size");
+        }
+        const uint32_t wx = f.gridWorkgroupX, wy = f.gridWorkgroupY;
+        std::fill(cells.begin(), cells.end(), 0u);
+        for (uint32_t y = 0; y < f.height; ++y) {
+            const uint8_t* row = detectionMask_.ptr<uint8_t>(int(y));
+            uint32_t* tileRow = cells.data() + size_t(y / wy) * gx;
+            for (uint32_t x = 0; x < gx; ++x) {
+                if (tileRow[x] != 0) continue;
+                const uint8_t* end = row + std::min(f.width, (x + 1) * wx);
+                tileRow[x] = std::any_of(row + x * wx, end, [](uint8_t v) { return v != 0; }) ? 1u : 0u;
+            }
+        }
+    }
+    std::memcpy(f.tiles.mapped, cells.data(), cells.size() * sizeof(uint32_t));
+    f.maskVersion = maskVersion_;
+}
+
+bool FastDetector::registerHostBuffer(const void* data, size_t bytes) {
+    const VkDeviceSize align = vk_.hostImportAlignment();
+    if (align == 0 || getHostPointerProperties_ == nullptr || bytes == 0 ||
+        reinterpret_cast<uintptr_t>(data) % align != 0) {
+        return false;
+    }
+    releaseHostBuffer(data);   // same address again: the new range replaces the old import
+    HostImport imp;
+    if (!importHostMemory(data, (VkDeviceSize(bytes) + align - 1) / align * align, imp)) return false;
+    imports_.push_back(imp);
+    return true;
+}
+
+void FastDetector::releaseHostBuffer(const void* data) {
+    auto it = std::find_if(imports_.begin(), imports_.end(), [&](const HostImport& i) { return i.base == data; });
+    if (it == imports_.end()) return;
+    const uint32_t n = uint32_t(frames_.size());
+    for (uint32_t i = 0; i < inFlight_; ++i) {
+        if (frames_[(next_ + n - 1 - i) % n].upload.buffer == it->buffer) {
+            throw std::runtime_error("FastDetector::releaseHostBuffer: a frame in flight reads from the buffer");
+        }
+    }
+    // Idle slots that recorded it are re-recorded on their next submit
+    for (Frame& f : frames_) {
+        if (f.recordedUpload.buffer == it->buffer) f.recordedUpload = UploadSource{};
+    }
+    destroyImport(*it);
+    imports_.erase(it);
+}
+
+bool FastDetector::importHostMemory(const void* base, VkDeviceSize size, HostImport& imp) {
+    VkMemoryHostPointerPropertiesEXT hostProps{VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT};
+    if (getHostPointerProperties_(vk_.device(), VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+                                  base, &hostProps) != VK_SUCCESS) {
+        return false;
+    }
+
+    imp.base = base;
+    imp.size = size;
+    VkExternalMemoryBufferCreateInfo external{VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO};
+    external.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+    VkBufferCreateInfo bi{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bi.pNext = &external;
+    bi.size = size;
+    bi.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    VK_CHECK(vkCreateBuffer(vk_.device(), &bi, nullptr, &imp.buffer), "vkCreateBuffer");
+
+    // Host writes must be visible without a flush, so only coherent types qualify
+    VkMemoryRequirements req;
+    vkGetBufferMemoryRequirements(vk_.device(), imp.buffer, &req);
+    VkPhysicalDeviceMemoryProperties memProps;
+    vkGetPhysicalDeviceMemoryProperties(vk_.physicalDevice(), &memProps);
+    const uint32_t types = req.memoryTypeBits & hostProps.memoryTypeBits;
+    const VkMemoryPropertyFlags wanted = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    uint32_t type = UINT32_MAX;
+    for (uint32_t i = 0; i < memProps.memoryTypeCount && type == UINT32_MAX; ++i) {
+        if ((types & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & wanted) == wanted) type = i;
+    }
+
+    VkImportMemoryHostPointerInfoEXT importInfo{VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT};
+    importInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+    importInfo.pHostPointer = const_cast<void*>(base);
+    VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    ai.pNext = &importInfo;
+    ai.allocationSize = size;
+    ai.memoryTypeIndex = type;
+    if (type == UINT32_MAX || vkAllocateMemory(vk_.device(), &ai, nullptr, &imp.memory) != VK_SUCCESS) {
+        destroyImport(imp);
+        return false;
+    }
+    VK_CHECK(vkBindBufferMemory(vk_.device(), imp.buffer, imp.memory, 0), "vkBindBufferMemory");
+    return true;
+}
+
+void FastDetector::destroyImport(HostImport& imp) {
+    if (imp.buffer != VK_NULL_HANDLE) vkDestroyBuffer(vk_.device(), imp.buffer, nullptr);
+    if (imp.memory != VK_NULL_HANDLE) vkFreeMemory(vk_.device(), imp.memory, nullptr);
+    imp = HostImport{};
+}
+
+FastDetector::Frame& FastDetector::waitOldest() {
+    if (inFlight_ == 0) throw std::runtime_error("FastDetector::collect: nothing in flight");
+
+    const uint32_t n = uint32_t(frames_.size());
+    const uint32_t oldest = (next_ + n - inFlight_) % n;
+    Frame& f = frames_[oldest];
+    auto t0 = std::chrono::steady_clock::now();
+    VK_CHECK(vkWaitForFences(vk_.device(), 1, &f.fence, VK_TRUE, UINT64_MAX), "vkWaitForFences");
+    auto t1 = std::chrono::steady_clock::now();
+    VK_CHECK(vkResetFences(vk_.device(), 1, &f.fence), "vkResetFences");
+    --inFlight_;
+    lastCollected_ = int(oldest);
+    f.waitStart = t0;
+    // A per-frame import ends with its frame; the caller may free the memory now
+    if (f.hostImport.buffer != VK_NULL_HANDLE) {
+        f.recordedUpload = UploadSource{};
+        destroyImport(f.hostImport);
+    }
+
+    if (opts_.profile) {
+        timings_.hostUpload = f.hostUploadMs;
+        timings_.hostWait = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        readTimestamps(f);
+    }
+    return f;
+}
+
+std::vector<Keypoint> FastDetector::collect() {
+    Frame& f = waitOldest();
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<Keypoint> kps = readKeypoints(f);
+    if (opts_.profile) {
+        timings_.hostReadback = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+    if (opts_.telemetry) reportTelemetry(f, uint32_t(kps.size()), t0);
+    return kps;
+}
+
+size_t FastDetector::collectInto(Keypoint* out, size_t capacity) {
+    Frame& f = waitOldest();
+    auto t0 = std::chrono::steady_clock::now();
+    const uint32_t count = keypointCount(f);
+    std::copy_n(keypointList(f), std::min<size_t>(count, capacity), out);
+    if (opts_.profile) {
+        timings_.hostReadback = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+    if (opts_.telemetry) reportTelemetry(f, count, t0);
+    return count;
+}
+
+void FastDetector::readTimestamps(const Frame& f) {
+    if (f.queries == VK_NULL_HANDLE) return;
+    uint64_t* ticks = stampTicks_;
+    VK_CHECK(vkGetQueryPoolResults(vk_.device(), f.queries, 0, kStampCount, sizeof(stampTicks_), ticks, sizeof(uint64_t),
+                                   VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT), "vkGetQueryPoolResults");
+    auto span = [&](Stamp from, Stamp to) {
+        return double((ticks[to] - ticks[from]) & timestampMask_) * timestampPeriod_ * 1e-6;
+    };
+    timings_.gpuUpload  = span(kStampBegin, kStampUpload);
+    timings_.gpuPyramid = span(kStampUpload, kStampPyramid);
+    timings_.gpuTrack   = span(kStampPyramid, kStampTrack);
+    timings_.gpuDetect  = span(kStampTrack, kStampDetect);
+    timings_.gpuSelect  = span(kStampDetect, kStampSelect);
+    timings_.gpuDescribe = span(kStampSelect, kStampDescribe);
+    timings_.gpuOverlay = span(kStampDescribe, kStampEnd);
+    timings_.gpuTotal   = span(kStampBegin, kStampEnd);
+}
+
+// --- Telemetry ---------------------------------------------------------------
+
+// Metric names for the stage that ends at each timestamp; the begin stamp stands for the whole frame
+static const char* const kStageNames[] = {"total", "upload", "pyramid", "track", "detect", "select", "describe", "overlay"};
+
+void FastDetector::registerMetrics() {
+    Telemetry& t = *opts_.telemetry;
+    const auto latency = Telemetry::latencyBuckets();
+    metrics_.frames = &t.counter("fast_frames_total", "Frame slots collected (a batch counts once)");
+    metrics_.keypoints = &t.counter("fast_keypoints_total", "Keypoints returned");
+    metrics_.overflows = &t.counter("fast_keypoint_overflows_total", "Frames that found more than maxKeypoints");
+    metrics_.rebuilds = &t.counter("fast_resource_rebuilds_total", "Slot resources recreated for a new frame size");
+    metrics_.keypointsPerFrame = &t.histogram("fast_keypoints_per_frame", "Keypoints returned per collected frame",
+                                              Telemetry::exponentialBuckets(16, 2, 13));
+    std::vector<double> slots(opts_.framesInFlight);
+    for (uint32_t i = 0; i < opts_.framesInFlight; ++i) slots[i] = i + 1;
+    metrics_.ringOccupancy = &t.histogram("fast_ring_occupancy", "Frame slots in flight right after a submit", slots);
+    const char* hostStages[] = {"upload", "wait", "readback"};
+    for (int i = 0; i < 3; ++i) {
+        metrics_.host[i] = &t.histogram("fast_host_stage_ms", "Host time per stage in ms (wait: fence wait in collect)",
+                                        latency, std::string("stage=\"") + hostStages[i] + "\"");
+    }
+    if (hasGpuTimestamps()) {
+        for (uint32_t s = 0; s < kStampCount; ++s) {
+            metrics_.gpu[s] = &t.histogram("fast_gpu_stage_ms", "GPU time per stage in ms (timestamp queries)",
+                                           latency, std::string("stage=\"") + kStageNames[s] + "\"");
+        }
+    }
+    metrics_.inFlight = &t.gauge("fast_ring_in_flight", "Frame slots currently submitted and not collected");
+    t.gauge("fast_ring_slots", "Frame slots in the ring").set(slotCount());
+    metrics_.heldBytes = &t.gauge("fast_device_memory_bytes", "Device memory", "kind=\"held\"");
+    metrics_.liveBytes = &t.gauge("fast_device_memory_bytes", "Device memory", "kind=\"live\"");
+    metrics_.liveAllocations = &t.gauge("fast_device_allocations", "Live sub-allocations and dedicated allocations");
+}
+
+void FastDetector::reportTelemetry(const Frame& f, uint32_t keypoints, Telemetry::Clock::time_point readStart) {
+    Telemetry& t = *opts_.telemetry;
+    metrics_.frames->add();
+    metrics_.keypoints->add(keypoints);
+    metrics_.keypointsPerFrame->observe(keypoints);
+    if (*static_cast<const uint32_t*>(f.keypoints.mapped) > opts_.maxKeypoints) metrics_.overflows->add();
+    metrics_.inFlight->set(inFlight_);
+    const MemoryAllocator::Stats mem = allocator_.stats();
+    metrics_.heldBytes->set(double(mem.blockBytes + mem.dedicatedBytes));
+    metrics_.liveBytes->set(double(mem.liveBytes));
+    metrics_.liveAllocations->set(mem.liveAllocations);
+
+    metrics_.host[0]->observe(timings_.hostUpload);
+    metrics_.host[1]->observe(timings_.hostWait);
+    metrics_.host[2]->observe(timings_.hostReadback);
+    const bool gpu = f.queries != VK_NULL_HANDLE && metrics_.gpu[0] != nullptr;
+    if (gpu) {
+        const double stages[kStampCount] = {timings_.gpuTotal, timings_.gpuUpload, timings_.gpuPyramid, timings_.gpuTrack,
+                                            timings_.gpuDetect, timings_.gpuSelect, timings_.gpuDescribe, timings_.gpuOverlay};
+        for (uint32_t s = 0; s < kStampCount; ++s) metrics_.gpu[s]->observe(stages[s]);
+    }
+
+    if (!t.tracing()) return;
+    using Ms = std::chrono::duration<double, std::milli>;
+    auto dur = [](double ms) { return std::chrono::duration_cast<Telemetry::Clock::duration>(Ms(ms)); };
+    const int64_t frame = int64_t(f.sequence);
+    if (timings_.hostUpload > 0) {
+        t.span("host", "upload", f.submitTime - dur(timings_.hostUpload), dur(timings_.hostUpload), frame);
+    }
+    t.span("host", "wait", f.waitStart, dur(timings_.hostWait), frame);
+    t.span("host", "readback", readStart, dur(timings_.hostReadback), frame);
+    if (!gpu) return;
+
+    // GPU ticks onto the host clock: the frame cannot start before its submit, so
+    // submit - begin bounds the offset from below and the running maximum converges
+    // to it. Approximate (no calibrated timestamps), but stable enough to line up
+    // the GPU lane with the host lane.
+    auto gpuNs = [&](Stamp s) { return int64_t(double(stampTicks_[s] & timestampMask_) * timestampPeriod_); };
+    const int64_t submitNs = std::chrono::duration_cast<std::chrono::nanoseconds>(f.submitTime.time_since_epoch()).count();
+    gpuClockOffsetNs_ = std::max(gpuClockOffsetNs_, submitNs - gpuNs(kStampBegin));
+    for (uint32_t s = kStampUpload; s < kStampCount; ++s) {
+        const int64_t from = gpuNs(Stamp(s - 1)), to = gpuNs(Stamp(s));
+        if (to <= from) continue;   // stage not recorded for this configuration
+        const Telemetry::Clock::time_point start{std::chrono::nanoseconds(from + gpuClockOffsetNs_)};
+        t.span("gpu", kStageNames[s], start, std::chrono::nanoseconds(to - from), frame);
+    }
+}
+
+float FastDetector::levelScale(uint32_t level) const {
+    return std::pow(opts_.pyramidScale, float(level));
+}
+
+std::vector<std::vector<Keypoint>> FastDetector::collectBatch() {
+    std::vector<Keypoint> all = collect();
+    std::vector<std::vector<Keypoint>> perImage(frames_[lastCollected_].layers);
+    for (const Keypoint& kp : all) perImage[kp.layer].push_back(kp);
+    return perImage;
+}
+
+uint32_t FastDetector::keypointCount(const Frame& f) const {
+    uint32_t count = *static_cast<const uint32_t*>(f.keypoints.mapped);
+    if (count > opts_.maxKeypoints) {
+        // Once per detector; fast_keypoint_overflows_total counts every frame
+        if (!overflowWarned_) {
+            std::cerr << "Keypoint buffer overflow: " << count << " found, kept " << opts_.maxKeypoints
+                      << " (reported once, raise maxKeypoints)\n";
+            overflowWarned_ = true;
+        }
+        count = opts_.maxKeypoints;
+    }
+    return count;
+}
+
+const Keypoint* FastDetector::keypointList(const Frame& f) const {
+    return reinterpret_cast<const Keypoint*>(static_cast<const uint8_t*>(f.keypoints.mapped) + sizeof(uint32_t));
+}
+
+std::vector<Keypoint> FastDetector::readKeypoints(const Frame& f) const {
+    const Keypoint* list = keypointList(f);
+    return std::vector<Keypoint>(list, list + keypointCount(f));
+}
+
+cv::Mat FastDetector::overlayRGBA(uint32_t layer) const {
+    if (!opts_.debugOverlay || lastCollected_ < 0) {
+        throw std::runtime_error("FastDetector::overlayImage: debugOverlay is off or no frame was collected");
+    }
+    const Frame& f = frames_[lastCollected_];
+    if (layer >= f.layers) throw std::runtime_error("FastDetector::overlayImage: layer out of range");
+    uint8_t* pixels = static_cast<uint8_t*>(f.readback.mapped) + size_t(layer) * f.width * f.height * 4;
+    return cv::Mat(int(f.height), int(f.width), CV_8UC4, pixels);
+}
+
+cv::Mat FastDetector::overlayImage(uint32_t layer) const {
+    cv::Mat bgr;
+    overlayImage(bgr, layer);
+    return bgr;
+}
+
+void FastDetector::overlayImage(cv::Mat& bgr, uint32_t layer) const {
+    cv::cvtColor(overlayRGBA(layer), bgr, cv::COLOR_RGBA2BGR);
+}
+
+cv::Mat FastDetector::descriptors() const {
+    if (!opts_.orb || lastCollected_ < 0) {
+        throw std::runtime_error("FastDetector::descriptors: orb is off or no frame was collected");
+    }
+    const Frame& f = frames_[lastCollected_];
+    return cv::Mat(int(keypointCount(f)), 32, CV_8UC1, f.descriptors.mapped).clone();
+}
+
+std::vector<float> FastDetector::angles() const {
+    if (!opts_.orb || lastCollected_ < 0) {
+        throw std::runtime_error("FastDetector::angles: orb is off or no frame was collected");
+    }
+    const Frame& f = frames_[lastCollected_];
+    const float* a = static_cast<const float*>(f.angles.mapped);
+    return std::vector<float>(a, a + keypointCount(f));
+}
+
+void FastDetector::trackPoints(const std::vector<cv::Point2f>& prevPts) {
+    if (opts_.maxTrackPoints == 0) throw std::runtime_error("FastDetector::trackPoints: maxTrackPoints is 0");
+    if (prevPts.size() > opts_.maxTrackPoints) {
+        throw std::runtime_error("FastDetector::trackPoints: " + std::to_string(prevPts.size()) +
+                                 " points exceed maxTrackPoints (" + std::to_string(opts_.maxTrackPoints) + ")");
+    }
+    pendingTrack_ = prevPts;
+}
+
+std::vector<FastDetector::Track> FastDetector::trackedPoints() const {
+    if (opts_.maxTrackPoints == 0 || lastCollected_ < 0) {
+        throw std::runtime_error("FastDetector::trackedPoints: maxTrackPoints is 0 or no frame was collected");
+    }
+    const Frame& f = frames_[lastCollected_];
+    const TrackSlot* slots = reinterpret_cast<const TrackSlot*>(static_cast<const uint8_t*>(f.track.mapped) + kTrackHeader);
+    std::vector<Track> out(f.trackCount);
+    for (uint32_t i = 0; i < f.trackCount; ++i) {
+        out[i] = {slots[i].nextX, slots[i].nextY, slots[i].status != 0, slots[i].error};
+    }
+    return out;
+}
+
+void FastDetector::setDetectionMask(const cv::Mat& mask) {
+    if (!opts_.tileMask) throw std::runtime_error("FastDetector::setDetectionMask: tileMask is off");
+    if (!mask.empty() && mask.type() != CV_8UC1) throw std::runtime_error("FastDetector::setDetectionMask: expected a CV_8UC1 mask");
+    detectionMask_ = mask.clone();
+    detectionTiles_.release();
+    ++maskVersion_;
+}
+
+void FastDetector::setDetectionTiles(const cv::Mat& tiles) {
+    if (!opts_.tileMask) throw std::runtime_error("FastDetector::setDetectionTiles: tileMask is off");
+    if (!tiles.empty() && tiles.type() != CV_8UC1) throw std::runtime_error("FastDetector::setDetectionTiles: expected CV_8UC1 tiles");
+    detectionTiles_ = tiles.clone();
+    detectionMask_.release();
+    ++maskVersion_;
+}
+
+cv::Size FastDetector::detectionTileGrid(uint32_t width, uint32_t height) const {
+    return cv::Size(int((width + opts_.workgroupX - 1) / opts_.workgroupX), int((height + opts_.workgroupY - 1) / opts_.workgroupY));
+}
+
+// --- Resource helpers --------------------------------------------------------
+
+void FastDetector::createImage(Image& img, VkFormat format, uint32_t width, uint32_t height, uint32_t layers) {
+    VkImageCreateInfo ici{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    ici.imageType = VK_IMAGE_TYPE_2D;
+    ici.extent = {width, height, 1};
+    ici.mipLevels = 1; ici.arrayLayers = layers;
+    ici.format = format;
+    ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    ici.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    ici.samples = VK_SAMPLE_COUNT_1_BIT; ici.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VK_CHECK(vkCreateImage(vk_.device(), &ici, nullptr, &img.image), "vkCreateImage");
+    img.memory = allocator_.allocateImage(img.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VkImageViewCreateInfo iv{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+    // Always an array view, the shaders index layers with gl_GlobalInvocationID.z
+    iv.image = img.image; iv.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY; iv.format = format;
+    iv.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0,1,0,layers};
+    VK_CHECK(vkCreateImageView(vk_.device(), &iv, nullptr, &img.view), "vkCreateImageView");
+}
+
+void FastDetector::destroyImage(Image& img) {
+    if (img.view != VK_NULL_HANDLE) vkDestroyImageView(vk_.device(), img.view, nullptr);
+    if (img.image != VK_NULL_HANDLE) vkDestroyImage(vk_.device(), img.image, nullptr);
+    allocator_.free(img.memory);
+    img = Image{};
+}
+
+void FastDetector::createBuffer(Buffer& buf, VkDeviceSize size, VkBufferUsageFlags usage,
+                                VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferred) {
+    VkBufferCreateInfo bi{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bi.size = size;
+    bi.usage = usage;
+    VK_CHECK(vkCreateBuffer(vk_.device(), &bi, nullptr, &buf.buffer), "vkCreateBuffer");
+    buf.memory = allocator_.allocateBuffer(buf.buffer, properties, preferred);
+    buf.size = size;
+    buf.mapped = buf.memory.mapped;   // the allocator maps host-visible blocks once
+}
+
+void FastDetector::destroyBuffer(Buffer& buf) {
+    if (buf.buffer != VK_NULL_HANDLE) vkDestroyBuffer(vk_.device(), buf.buffer, nullptr);
+    allocator_.free(buf.memory);
+    buf = Buffer{};
+}
+
+void FastDetector::createPipeline(Pipeline& p, const std::string& spvName, VkDescriptorSetLayout setLayout,
+                                  uint32_t pushConstantSize, const VkSpecializationInfo* spec) {
+    auto code = loadShaderCode(spvName, opts_.shaderDir);
+    VkShaderModuleCreateInfo smci{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+    smci.codeSize = code.size();
+    smci.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    VK_CHECK(vkCreateShaderModule(vk_.device(), &smci, nullptr, &p.module), "vkCreateShaderModule");
+
+    VkPipelineLayoutCreateInfo plci{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    plci.setLayoutCount = 1; plci.pSetLayouts = &setLayout;
+    VkPushConstantRange pcr{VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize};
+    if (pushConstantSize > 0) { plci.pushConstantRangeCount = 1; plci.pPushConstantRanges = &pcr; }
+    VK_CHECK(vkCreatePipelineLayout(vk_.device(), &plci, nullptr, &p.layout), "vkCreatePipelineLayout");
+
+    VkComputePipelineCreateInfo cpci{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+    cpci.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0,
+                  VK_SHADER_STAGE_COMPUTE_BIT, p.module, "main", spec};
+    cpci.layout = p.layout;
+    VK_CHECK(vkCreateComputePipelines(vk_.device(), pipelineCache_->handle(), 1, &cpci, nullptr, &p.pipeline), "vkCreateComputePipelines");
+}
+
+void FastDetector::destroyPipeline(Pipeline& p) {
+    if (p.pipeline != VK_NULL_HANDLE) vkDestroyPipeline(vk_.device(), p.pipeline, nullptr);
+    if (p.layout != VK_NULL_HANDLE) vkDestroyPipelineLayout(vk_.device(), p.layout, nullptr);
+    if (p.module != VK_NULL_HANDLE) vkDestroyShaderModule(vk_.device(), p.module, nullptr);
+    p = Pipeline{};
+}
+
+VkCommandBuffer FastDetector::beginOneShot() {
+    VkCommandBufferAllocateInfo ai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    ai.commandPool = cmdPool_; ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; ai.commandBufferCount = 1;
+    VkCommandBuffer cmd{};
+    VK_CHECK(vkAllocateCommandBuffers(vk_.device(), &ai, &cmd), "vkAllocateCommandBuffers");
+    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(cmd, &bi), "vkBeginCommandBuffer");
+    return cmd;
+}
+
+void FastDetector::endOneShot(VkCommandBuffer cmd) {
+    VK_CHECK(vkEndCommandBuffer(cmd), "vkEndCommandBuffer");
+    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO}; si.commandBufferCount = 1; si.pCommandBuffers = &cmd;
+    VK_CHECK(vkQueueSubmit(queue_, 1, &si, VK_NULL_HANDLE), "vkQueueSubmit");
+    VK_CHECK(vkQueueWaitIdle(queue_), "vkQueueWaitIdle");
+    vkFreeCommandBuffers(vk_.device(), cmdPool_, 1, &cmd);
+}
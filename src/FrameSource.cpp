@@ -0,0 +1,184 @@
+#include "FrameSource.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cctype>
+
+static const char kY8Magic[8] = {'F', 'A', 'S', 'T', 'Y', '8', 0, 0};
+static constexpr uint32_t kY8Version = 1;
+static_assert(sizeof(Y8Header) == 48, "Y8Header is part of the file format");
+static_assert(sizeof(Y8IndexEntry) == 16, "Y8IndexEntry is part of the file format");
+
+static std::string lowerExtension(const std::filesystem::path& p) {
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    return ext;
+}
+
+// --- FrameSource -------------------------------------------------------------
+
+std::unique_ptr<FrameSource> FrameSource::open(const std::string& path, unsigned threads, unsigned prefetch) {
+    namespace fs = std::filesystem;
+    const fs::path p(path);
+    if (lowerExtension(p) == ".y8") return std::make_unique<Y8Sequence>(path, prefetch > 0 ? prefetch : 4);
+
+    std::vector<std::string> paths;
+    if (fs::is_directory(p)) {
+        static const char* kImageExtensions[] = {".jpg", ".jpeg", ".png", ".bmp", ".pgm", ".ppm", ".tif", ".tiff", ".webp"};
+        for (const fs::directory_entry& e : fs::directory_iterator(p)) {
+            if (!e.is_regular_file()) continue;
+            const std::string ext = lowerExtension(e.path());
+            for (const char* known : kImageExtensions) {
+                if (ext == known) { paths.push_back(e.path().string()); break; }
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+    } else if (lowerExtension(p) == ".txt") {
+        // One path per line, relative ones are relative to the list
+        std::ifstream list(path);
+        if (!list) throw std::runtime_error("FrameSource: cannot open " + path);
+        for (std::string line; std::getline(list, line);) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            const fs::path entry(line);
+            paths.push_back(entry.is_absolute() ? line : (p.parent_path() / entry).string());
+        }
+    } else {
+        paths.push_back(path);
+    }
+    if (paths.empty()) throw std::runtime_error("FrameSource: no images in " + path);
+    return std::make_unique<ImageSequence>(std::move(paths), threads, prefetch);
+}
+
+// --- ImageSequence -----------------------------------------------------------
+
+ImageSequence::ImageSequence(std::vector<std::string> paths, unsigned threads, unsigned prefetch)
+    : paths_(std::move(paths)), pool_(threads), prefetch_(prefetch > 0 ? prefetch : 2 * pool_.size()) {
+    schedule();
+}
+
+ImageSequence::~ImageSequence() {
+    // The pool joins its workers; outstanding decodes only touch their own Mat
+    for (auto& f : pending_) f.wait();
+}
+
+void ImageSequence::schedule() {
+    while (pending_.size() < prefetch_ && scheduled_ < paths_.size()) {
+        const std::string& path = paths_[scheduled_++];
+        pending_.push_back(pool_.submit([&path] {
+            cv::Mat m = cv::imread(path, cv::IMREAD_GRAYSCALE);
+            if (m.empty()) throw std::runtime_error("ImageSequence: cannot decode " + path);
+            return m;
+        }));
+    }
+}
+
+cv::Mat ImageSequence::next() {
+    if (pending_.empty()) return cv::Mat();
+    std::future<cv::Mat> f = std::move(pending_.front());
+    pending_.pop_front();
+    schedule();   // refill before blocking, so the window stays full while we wait
+    return f.get();
+}
+
+// --- Y8Sequence --------------------------------------------------------------
+
+Y8Sequence::Y8Sequence(const std::string& path, unsigned prefetch) : file_(path), prefetch_(prefetch) {
+    if (file_.size() < sizeof(Y8Header)) throw std::runtime_error("Y8Sequence: " + path + " is too small for a .y8 header");
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    const bool valid = std::memcmp(header_.magic, kY8Magic, sizeof(kY8Magic)) == 0 && header_.version == kY8Version &&
+                       header_.width > 0 && header_.height > 0 && header_.stride >= header_.width &&
+                       header_.indexOffset % 8 == 0 && header_.frameCount <= file_.size() / sizeof(Y8IndexEntry) &&
+                       file_.contains(header_.indexOffset, header_.frameCount * sizeof(Y8IndexEntry));
+    if (!valid) throw std::runtime_error("Y8Sequence: " + path + " is not a valid .y8 file (or was not closed)");
+    index_ = reinterpret_cast<const Y8IndexEntry*>(file_.data() + header_.indexOffset);
+    const uint64_t frameBytes = uint64_t(header_.stride) * header_.height;
+    for (uint64_t i = 0; i < header_.frameCount; ++i) {
+        if (!file_.contains(index_[i].offset, frameBytes)) {
+            throw std::runtime_error("Y8Sequence: frame " + std::to_string(i) + " of " + path + " is truncated");
+        }
+    }
+    file_.sequential();
+    advise(0, prefetch_ + 1);
+}
+
+void Y8Sequence::advise(size_t first, size_t count) const {
+    // Page-cache readahead for the frames about to be used
+    const size_t frameBytes = size_t(header_.stride) * header_.height;
+    for (size_t i = first; i < std::min<size_t>(first + count, frameCount()); ++i) {
+        file_.prefetch(size_t(index_[i].offset), frameBytes);
+    }
+}
+
+cv::Mat Y8Sequence::frame(size_t i) const {
+    if (i >= frameCount()) throw std::runtime_error("Y8Sequence: frame index out of range");
+    return cv::Mat(int(header_.height), int(header_.width), CV_8UC1, const_cast<uint8_t*>(file_.data()) + index_[i].offset, header_.stride);
+}
+
+cv::Mat Y8Sequence::next() {
+    if (next_ >= frameCount()) return cv::Mat();
+    // Frames up to next_ + prefetch_ were requested already; ask for the one entering the window
+    advise(next_ + prefetch_ + 1, 1);
+    return frame(next_++);
+}
+
+// --- Y8Writer ----------------------------------------------------------------
+
+Y8Writer::Y8Writer(const std::string& path, uint32_t width, uint32_t height) : path_(path) {
+    if (width == 0 || height == 0) throw std::runtime_error("Y8Writer: empty frame size");
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_) throw std::runtime_error("Y8Writer: cannot create " + path);
+    std::memcpy(header_.magic, kY8Magic, sizeof(kY8Magic));
+    header_.version = kY8Version;
+    header_.width = width;
+    header_.height = height;
+    header_.stride = width;
+    header_.alignment = 4096;   // covers common page sizes and minImportedHostPointerAlignment
+    // Placeholder header; frameCount = 0 and no index until close()
+    out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+}
+
+Y8Writer::~Y8Writer() {
+    try { close(); } catch (...) {}
+}
+
+void Y8Writer::append(const cv::Mat& frame, int64_t timestampNs) {
+    if (!out_.is_open()) throw std::runtime_error("Y8Writer: " + path_ + " is closed");
+    if (frame.cols != int(header_.width) || frame.rows != int(header_.height)) {
+        throw std::runtime_error("Y8Writer: frame size differs from the file's");
+    }
+    const cv::Mat* src = &frame;
+    if (frame.type() == CV_8UC3) {
+        cv::cvtColor(frame, gray_, cv::COLOR_BGR2GRAY);
+        src = &gray_;
+    } else if (frame.type() != CV_8UC1) {
+        throw std::runtime_error("Y8Writer: expected an 8-bit grayscale or BGR frame");
+    }
+
+    const uint64_t pos = uint64_t(out_.tellp());
+    const uint64_t offset = (pos + header_.alignment - 1) / header_.alignment * header_.alignment;
+    static const char zeros[4096] = {};
+    out_.write(zeros, std::streamsize(offset - pos));
+    for (int y = 0; y < src->rows; ++y) out_.write(reinterpret_cast<const char*>(src->ptr(y)), header_.width);
+    if (!out_) throw std::runtime_error("Y8Writer: write to " + path_ + " failed");
+    index_.push_back({offset, timestampNs});
+}
+
+void Y8Writer::close() {
+    if (!out_.is_open()) return;
+    // Frames end at any byte; pad so the mapped index is 8-byte aligned
+    const uint64_t pos = uint64_t(out_.tellp());
+    header_.indexOffset = (pos + 7) / 8 * 8;
+    header_.frameCount = index_.size();
+    static const char zeros[8] = {};
+    out_.write(zeros, std::streamsize(header_.indexOffset - pos));
+    out_.write(reinterpret_cast<const char*>(index_.data()), std::streamsize(index_.size() * sizeof(Y8IndexEntry)));
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    const bool ok = bool(out_);
+    out_.close();
+    if (!ok) throw std::runtime_error("Y8Writer: finishing " + path_ + " failed");
+}
@@ -0,0 +1,122 @@
+#include "KeypointStream.h"
+#include <stdexcept>
+#include <cstring>
+
+static const char kKpsMagic[8] = {'F', 'A', 'S', 'T', 'K', 'P', 0, 0};
+static constexpr uint32_t kKpsVersion = 1;
+static_assert(sizeof(KpsHeader) == 40, "KpsHeader is part of the file format");
+static_assert(sizeof(KpsIndexEntry) == 24, "KpsIndexEntry is part of the file format");
+static_assert(sizeof(Keypoint) == 20, "Keypoint records are part of the file format");
+
+// --- KeypointWriter ----------------------------------------------------------
+
+KeypointWriter::KeypointWriter(const std::string& path, uint32_t descriptorBytes, size_t maxPending)
+    : path_(path), maxPending_(maxPending > 0 ? maxPending : 1) {
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_) throw std::runtime_error("KeypointWriter: cannot create " + path);
+    std::memcpy(header_.magic, kKpsMagic, sizeof(kKpsMagic));
+    header_.version = kKpsVersion;
+    header_.recordBytes = sizeof(Keypoint);
+    header_.descriptorBytes = descriptorBytes;
+    // Placeholder header; frameCount = 0 and no index until close()
+    out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+}
+
+KeypointWriter::~KeypointWriter() {
+    try { close(); } catch (...) {}
+}
+
+void KeypointWriter::append(std::vector<Keypoint> keypoints, const cv::Mat& descriptors, int64_t timestampNs) {
+    if (closed_) throw std::runtime_error("KeypointWriter: " + path_ + " is closed");
+    cv::Mat desc;
+    if (header_.descriptorBytes > 0) {
+        if (descriptors.rows != int(keypoints.size()) || descriptors.cols != int(header_.descriptorBytes) ||
+            descriptors.type() != CV_8UC1) {
+            throw std::runtime_error("KeypointWriter: expected " + std::to_string(keypoints.size()) + " x " +
+                                     std::to_string(header_.descriptorBytes) + " CV_8U descriptors");
+        }
+        desc = descriptors.clone();   // continuous and owned by the queued frame
+    }
+    while (pending_.size() >= maxPending_) waitOldest();
+    pending_.push_back(worker_.submit([this, kps = std::move(keypoints), desc, timestampNs] {
+        write(kps, desc, timestampNs);
+    }));
+    ++appended_;
+}
+
+void KeypointWriter::waitOldest() {
+    std::future<void> f = std::move(pending_.front());
+    pending_.pop_front();
+    f.get();   // rethrows write errors
+}
+
+void KeypointWriter::write(const std::vector<Keypoint>& keypoints, const cv::Mat& descriptors, int64_t timestampNs) {
+    // Records and descriptors are multiples of 4 bytes; pad the block start to 8
+    const uint64_t pos = uint64_t(out_.tellp());
+    const uint64_t offset = (pos + 7) / 8 * 8;
+    static const char zeros[8] = {};
+    out_.write(zeros, std::streamsize(offset - pos));
+    out_.write(reinterpret_cast<const char*>(keypoints.data()), std::streamsize(keypoints.size() * sizeof(Keypoint)));
+    if (!descriptors.empty()) {
+        out_.write(reinterpret_cast<const char*>(descriptors.data), std::streamsize(descriptors.total()));
+    }
+    if (!out_) throw std::runtime_error("KeypointWriter: write to " + path_ + " failed");
+    index_.push_back({offset, uint32_t(keypoints.size()), 0, timestampNs});
+}
+
+void KeypointWriter::close() {
+    if (closed_) return;
+    closed_ = true;
+    std::exception_ptr error;
+    while (!pending_.empty()) {
+        try { waitOldest(); } catch (...) { if (!error) error = std::current_exception(); }
+    }
+    if (!error) {
+        const uint64_t pos = uint64_t(out_.tellp());
+        header_.indexOffset = (pos + 7) / 8 * 8;
+        header_.frameCount = index_.size();
+        static const char zeros[8] = {};
+        out_.write(zeros, std::streamsize(header_.indexOffset - pos));
+        out_.write(reinterpret_cast<const char*>(index_.data()), std::streamsize(index_.size() * sizeof(KpsIndexEntry)));
+        out_.seekp(0);
+        out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+        if (!out_) error = std::make_exception_ptr(std::runtime_error("KeypointWriter: finishing " + path_ + " failed"));
+    }
+    out_.close();
+    if (error) std::rethrow_exception(error);
+}
+
+// --- KeypointReader ----------------------------------------------------------
+
+KeypointReader::KeypointReader(const std::string& path) : file_(path) {
+    if (file_.size() < sizeof(KpsHeader)) throw std::runtime_error("KeypointReader: " + path + " is too small for a .kps header");
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    const bool valid = std::memcmp(header_.magic, kKpsMagic, sizeof(kKpsMagic)) == 0 && header_.version == kKpsVersion &&
+                       header_.recordBytes == sizeof(Keypoint) && header_.indexOffset % 8 == 0 &&
+                       header_.frameCount <= file_.size() / sizeof(KpsIndexEntry) &&
+                       file_.contains(header_.indexOffset, header_.frameCount * sizeof(KpsIndexEntry));
+    if (!valid) throw std::runtime_error("KeypointReader: " + path + " is not a valid .kps file (or was not closed)");
+    index_ = reinterpret_cast<const KpsIndexEntry*>(file_.data() + header_.indexOffset);
+    for (uint64_t i = 0; i < header_.frameCount; ++i) {
+        const uint64_t bytes = uint64_t(index_[i].count) * (header_.recordBytes + header_.descriptorBytes);
+        if (index_[i].offset % 8 != 0 || !file_.contains(index_[i].offset, bytes)) {
+            throw std::runtime_error("KeypointReader: frame " + std::to_string(i) + " of " + path + " is truncated");
+        }
+    }
+}
+
+const KpsIndexEntry& KeypointReader::entry(size_t frame) const {
+    if (frame >= frameCount()) throw std::runtime_error("KeypointReader: frame index out of range");
+    return index_[frame];
+}
+
+const Keypoint* KeypointReader::keypoints(size_t frame) const {
+    return reinterpret_cast<const Keypoint*>(file_.data() + entry(frame).offset);
+}
+
+cv::Mat KeypointReader::descriptors(size_t frame) const {
+    const KpsIndexEntry& e = entry(frame);
+    if (header_.descriptorBytes == 0 || e.count == 0) return cv::Mat();
+    uint8_t* rows = const_cast<uint8_t*>(file_.data()) + e.offset + uint64_t(e.count) * sizeof(Keypoint);
+    return cv::Mat(int(e.count), int(header_.descriptorBytes), CV_8UC1, rows);
+}
@@ -0,0 +1,169 @@
+#include "MemoryAllocator.h"
+#include "VulkanUtils.h"
+#include <algorithm>
+
+// Smallest size class; also covers the usual buffer/image alignments
+static constexpr VkDeviceSize kMinClass = 256;
+
+static VkDeviceSize sizeClass(VkDeviceSize size, VkDeviceSize alignment) {
+    VkDeviceSize c = kMinClass;
+    while (c < size || c < alignment) c <<= 1;
+    return c;
+}
+
+MemoryAllocator::MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize)
+    : device_(device), blockSize_(blockSize) {
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProps_);
+    pools_.resize(size_t(memProps_.memoryTypeCount) * 2);
+    for (uint32_t i = 0; i < pools_.size(); ++i) pools_[i].memoryType = i / 2;
+}
+
+MemoryAllocator::~MemoryAllocator() {
+    // Resources must be gone by now; dedicated allocations were freed with them
+    for (Pool& pool : pools_) {
+        for (Block& b : pool.blocks) {
+            if (b.memory == VK_NULL_HANDLE) continue;
+            if (b.mapped != nullptr) vkUnmapMemory(device_, b.memory);
+            vkFreeMemory(device_, b.memory, nullptr);
+        }
+    }
+}
+
+MemoryAllocator::Allocation MemoryAllocator::allocateImage(VkImage image, VkMemoryPropertyFlags required,
+                                                           VkMemoryPropertyFlags preferred) {
+    VkMemoryRequirements mr{};
+    vkGetImageMemoryRequirements(device_, image, &mr);
+    Allocation a = allocate(mr, false, required, preferred, mr.size);
+    VK_CHECK(vkBindImageMemory(device_, image, a.memory, a.offset), "vkBindImageMemory");
+    return a;
+}
+
+MemoryAllocator::Allocation MemoryAllocator::allocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags required,
+                                                            VkMemoryPropertyFlags preferred) {
+    VkMemoryRequirements mr{};
+    vkGetBufferMemoryRequirements(device_, buffer, &mr);
+    Allocation a = allocate(mr, true, required, preferred, mr.size);
+    VK_CHECK(vkBindBufferMemory(device_, buffer, a.memory, a.offset), "vkBindBufferMemory");
+    return a;
+}
+
+MemoryAllocator::Allocation MemoryAllocator::allocate(const VkMemoryRequirements& req, bool linear,
+                                                      VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+                                                      VkDeviceSize requested) {
+    const uint32_t type = findMemoryType(req.memoryTypeBits, memProps_, required, preferred);
+    const uint32_t poolIndex = type * 2 + (linear ? 1 : 0);
+    Pool& pool = pools_[poolIndex];
+    const bool hostVisible = (memProps_.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+
+    Allocation a;
+    a.pool = poolIndex;
+    a.requested = requested;
+    const VkDeviceSize cls = sizeClass(req.size, req.alignment);
+
+    if (cls > blockSize_ / 2) {
+        void* mapped = nullptr;
+        a.memory = allocateDeviceMemory(type, req.size, hostVisible ? &mapped : nullptr);
+        a.size = req.size;
+        a.mapped = mapped;
+        a.block = kDedicated;
+        ++stats_.dedicated;
+        stats_.dedicatedBytes += a.size;
+    } else {
+        auto& ranges = pool.freeRanges[cls];
+        if (!ranges.empty()) {
+            const FreeRange r = ranges.back();
+            ranges.pop_back();
+            a.block = r.block;
+            a.offset = r.offset;
+            ++stats_.reused;
+        } else {
+            // Bump from the first block with room; offsets are multiples of the class
+            uint32_t bi = 0;
+            for (; bi < pool.blocks.size(); ++bi) {
+                const Block& b = pool.blocks[bi];
+                if (b.memory != VK_NULL_HANDLE && (b.used + cls - 1) / cls * cls + cls <= b.size) break;
+            }
+            if (bi == pool.blocks.size()) {
+                // Reuse a slot of a trimmed block if there is one
+                bi = 0;
+                while (bi < pool.blocks.size() && pool.blocks[bi].memory != VK_NULL_HANDLE) ++bi;
+                if (bi == pool.blocks.size()) pool.blocks.emplace_back();
+                Block& b = pool.blocks[bi];
+                b.memory = allocateDeviceMemory(type, blockSize_, hostVisible ? &b.mapped : nullptr);
+                b.size = blockSize_;
+                b.used = 0;
+                ++stats_.blocks;
+                stats_.blockBytes += b.size;
+            }
+            Block& b = pool.blocks[bi];
+            a.block = bi;
+            a.offset = (b.used + cls - 1) / cls * cls;
+            b.used = a.offset + cls;
+        }
+        Block& b = pool.blocks[a.block];
+        ++b.live;
+        a.memory = b.memory;
+        a.size = cls;
+        a.mapped = b.mapped != nullptr ? static_cast<char*>(b.mapped) + a.offset : nullptr;
+    }
+    ++stats_.liveAllocations;
+    stats_.liveBytes += a.size;
+    stats_.requestedBytes += a.requested;
+    return a;
+}
+
+void MemoryAllocator::free(Allocation& a) {
+    if (a.memory == VK_NULL_HANDLE) return;
+    --stats_.liveAllocations;
+    stats_.liveBytes -= a.size;
+    stats_.requestedBytes -= a.requested;
+
+    if (a.block == kDedicated) {
+        if (a.mapped != nullptr) vkUnmapMemory(device_, a.memory);
+        vkFreeMemory(device_, a.memory, nullptr);
+        --stats_.dedicated;
+        stats_.dedicatedBytes -= a.size;
+    } else {
+        Pool& pool = pools_[a.pool];
+        Block& b = pool.blocks[a.block];
+        if (--b.live == 0) {
+            // Empty block: drop its free ranges and let it start over for any class
+            for (auto& entry : pool.freeRanges) {
+                auto& ranges = entry.second;
+                ranges.erase(std::remove_if(ranges.begin(), ranges.end(),
+                                            [&](const FreeRange& r) { return r.block == a.block; }),
+                             ranges.end());
+            }
+            b.used = 0;
+        } else {
+            pool.freeRanges[a.size].push_back({a.block, a.offset});
+        }
+    }
+    a = Allocation{};
+}
+
+void MemoryAllocator::trim() {
+    for (Pool& pool : pools_) {
+        for (Block& b : pool.blocks) {
+            if (b.memory == VK_NULL_HANDLE || b.live > 0) continue;
+            if (b.mapped != nullptr) vkUnmapMemory(device_, b.memory);
+            vkFreeMemory(device_, b.memory, nullptr);
+            --stats_.blocks;
+            stats_.blockBytes -= b.size;
+            b = Block{};
+        }
+    }
+}
+
+VkDeviceMemory MemoryAllocator::allocateDeviceMemory(uint32_t memoryType, VkDeviceSize size, void** mapped) {
+    VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    mai.allocationSize = size;
+    mai.memoryTypeIndex = memoryType;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VK_CHECK(vkAllocateMemory(device_, &mai, nullptr, &memory), "vkAllocateMemory");
+    ++stats_.deviceAllocations;
+    if (mapped != nullptr) {
+        VK_CHECK(vkMapMemory(device_, memory, 0, VK_WHOLE_SIZE, 0, mapped), "vkMapMemory");
+    }
+    return memory;
+}
@@ -0,0 +1,90 @@
+#include "PipelineCache.h"
+#include "VulkanUtils.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+#include <utility>
+
+static constexpr uint32_t kMagic = 0x43505346;   // "FSPC"
+static constexpr uint32_t kVersion = 1;
+
+PipelineCache::PipelineCache(const VulkanSetup& vk, std::string path)
+    : vk_(vk), path_(std::move(path)) {
+    std::vector<char> data;
+    if (!path_.empty()) {
+        std::ifstream file(path_, std::ios::binary | std::ios::ate);
+        if (file.is_open()) {
+            const size_t fileSize = size_t(file.tellg());
+            file.seekg(0);
+            FileHeader header{};
+            const FileHeader expected = expectedHeader();
+            if (fileSize >= sizeof(header) && file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+                header.dataSize == fileSize - sizeof(header) &&
+                std::memcmp(&header, &expected, offsetof(FileHeader, dataSize)) == 0) {
+                data.resize(size_t(header.dataSize));
+                if (!file.read(data.data(), std::streamsize(data.size()))) data.clear();
+            } else {
+                std::cerr << "Pipeline cache " << path_ << " is from another device or driver, rebuilding" << std::endl;
+            }
+        }
+    }
+
+    VkPipelineCacheCreateInfo ci{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    ci.initialDataSize = data.size();
+    ci.pInitialData = data.empty() ? nullptr : data.data();
+    VK_CHECK(vkCreatePipelineCache(vk_.device(), &ci, nullptr, &cache_), "vkCreatePipelineCache");
+    loaded_ = !data.empty();
+    savedSize_ = data.size();
+}
+
+PipelineCache::~PipelineCache() {
+    if (cache_ == VK_NULL_HANDLE) return;
+    save();
+    vkDestroyPipelineCache(vk_.device(), cache_, nullptr);
+}
+
+PipelineCache::FileHeader PipelineCache::expectedHeader() const {
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(vk_.physicalDevice(), &props);
+    FileHeader h{};
+    h.magic = kMagic;
+    h.version = kVersion;
+    h.vendorID = props.vendorID;
+    h.deviceID = props.deviceID;
+    h.driverVersion = props.driverVersion;
+    std::memcpy(h.uuid, props.pipelineCacheUUID, VK_UUID_SIZE);
+    return h;
+}
+
+void PipelineCache::save() {
+    if (path_.empty()) return;
+    size_t size = 0;
+    VK_CHECK(vkGetPipelineCacheData(vk_.device(), cache_, &size, nullptr), "vkGetPipelineCacheData");
+    if (size == 0 || size == savedSize_) return;
+    std::vector<char> data(size);
+    VK_CHECK(vkGetPipelineCacheData(vk_.device(), cache_, &size, data.data()), "vkGetPipelineCacheData");
+
+    FileHeader header = expectedHeader();
+    header.dataSize = size;
+    // Write next to the target and rename, so a crashed or concurrent writer never
+    // leaves a truncated file behind
+    const std::string tmp = path_ + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), std::streamsize(size));
+        if (!file) {
+            std::cerr << "Could not write pipeline cache " << tmp << std::endl;
+            return;
+        }
+    }
+    if (std::rename(tmp.c_str(), path_.c_str()) != 0) {
+        std::cerr << "Could not replace pipeline cache " << path_ << std::endl;
+        std::remove(tmp.c_str());
+        return;
+    }
+    savedSize_ = size;
+}
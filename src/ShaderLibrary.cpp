@@ -0,0 +1,35 @@
+#include "ShaderLibrary.h"
+#include "VulkanUtils.h"
+#include <cstring>
+
+#ifdef FAST_EMBED_SHADERS
+#include "EmbeddedShaders.h"
+#endif
+
+#ifndef SHADER_DIR
+#define SHADER_DIR "shaders"
+#endif
+
+std::vector<char> loadShaderCode(const std::string& name, const std::string& dir) {
+    if (!dir.empty()) return readFile(dir + "/" + name);
+#ifdef FAST_EMBED_SHADERS
+    for (const embedded::Shader* s = embedded::kShaders; s->name != nullptr; ++s) {
+        if (name == s->name) {
+            std::vector<char> code(s->size);
+            std::memcpy(code.data(), s->code, s->size);
+            return code;
+        }
+    }
+    throw std::runtime_error("Shader " + name + " is not embedded in this binary");
+#else
+    return readFile(std::string(SHADER_DIR) + "/" + name);
+#endif
+}
+
+bool hasEmbeddedShaders() {
+#ifdef FAST_EMBED_SHADERS
+    return true;
+#else
+    return false;
+#endif
+}
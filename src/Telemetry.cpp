@@ -0,0 +1,151 @@
+#include "Telemetry.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// --- Histogram ---------------------------------------------------------------
+
+Telemetry::Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)), counts_(new std::atomic<uint64_t>[bounds_.size() + 1]) {
+    if (!std::is_sorted(bounds_.begin(), bounds_.end())) throw std::runtime_error("Telemetry: histogram bounds must be sorted");
+    for (size_t i = 0; i <= bounds_.size(); ++i) counts_[i].store(0, std::memory_order_relaxed);
+}
+
+void Telemetry::Histogram::observe(double v) {
+    const size_t bucket = size_t(std::lower_bound(bounds_.begin(), bounds_.end(), v) - bounds_.begin());
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+    double sum = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(sum, sum + v, std::memory_order_relaxed)) {}
+}
+
+Telemetry::Histogram::Snapshot Telemetry::Histogram::snapshot() const {
+    // Buckets are read one by one, so a concurrent observe() may be half visible;
+    // count is taken from the buckets so the exposition stays self-consistent
+    Snapshot s;
+    s.bounds = bounds_;
+    s.counts.resize(bounds_.size() + 1);
+    for (size_t i = 0; i <= bounds_.size(); ++i) {
+        s.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        s.count += s.counts[i];
+    }
+    s.sum = sum_.load(std::memory_order_relaxed);
+    return s;
+}
+
+std::vector<double> Telemetry::exponentialBuckets(double start, double factor, size_t count) {
+    std::vector<double> bounds(count);
+    for (size_t i = 0; i < count; ++i, start *= factor) bounds[i] = start;
+    return bounds;
+}
+
+// --- Registry ----------------------------------------------------------------
+
+Telemetry::Telemetry(size_t maxTraceEvents) : maxTraceEvents_(maxTraceEvents) {}
+
+Telemetry::Family& Telemetry::family(const std::string& name, const char* type, const std::string& help) {
+    Family& f = families_[name];
+    if (f.type.empty()) {
+        f.type = type;
+        f.help = help;
+    } else if (f.type != type) {
+        throw std::runtime_error("Telemetry: " + name + " is already registered as a " + f.type);
+    }
+    return f;
+}
+
+Telemetry::Counter& Telemetry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    auto& slot = family(name, "counter", help).counters[labels];
+    if (!slot) slot = std::make_unique<Counter>();
+    return *slot;
+}
+
+Telemetry::Gauge& Telemetry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    auto& slot = family(name, "gauge", help).gauges[labels];
+    if (!slot) slot = std::make_unique<Gauge>();
+    return *slot;
+}
+
+Telemetry::Histogram& Telemetry::histogram(const std::string& name, const std::string& help, std::vector<double> bounds,
+                                           const std::string& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    auto& slot = family(name, "histogram", help).histograms[labels];
+    if (!slot) slot = std::make_unique<Histogram>(std::move(bounds));
+    return *slot;
+}
+
+std::string Telemetry::scrape() const {
+    // Registration only inserts, and metric values are atomics, so holding the
+    // registry lock while formatting never stalls an update
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    std::ostringstream out;
+    out.precision(10);
+    auto braces = [](const std::string& labels) { return labels.empty() ? std::string() : "{" + labels + "}"; };
+    for (const auto& [name, f] : families_) {
+        out << "# HELP " << name << ' ' << f.help << "\n# TYPE " << name << ' ' << f.type << '\n';
+        for (const auto& [labels, c] : f.counters) out << name << braces(labels) << ' ' << c->value() << '\n';
+        for (const auto& [labels, g] : f.gauges) out << name << braces(labels) << ' ' << g->value() << '\n';
+        for (const auto& [labels, h] : f.histograms) {
+            const Histogram::Snapshot s = h->snapshot();
+            const std::string sep = labels.empty() ? "" : labels + ",";
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < s.bounds.size(); ++i) {
+                cumulative += s.counts[i];
+                out << name << "_bucket{" << sep << "le=\"" << s.bounds[i] << "\"} " << cumulative << '\n';
+            }
+            out << name << "_bucket{" << sep << "le=\"+Inf\"} " << s.count << '\n';
+            out << name << "_sum" << braces(labels) << ' ' << s.sum << '\n';
+            out << name << "_count" << braces(labels) << ' ' << s.count << '\n';
+        }
+    }
+    return out.str();
+}
+
+// --- Trace -------------------------------------------------------------------
+
+void Telemetry::span(const std::string& lane, const std::string& name, Clock::time_point start, Clock::duration duration,
+                     int64_t frame) {
+    if (maxTraceEvents_ == 0) return;
+    const double startUs = std::chrono::duration<double, std::micro>(start - origin_).count();
+    const double durationUs = std::chrono::duration<double, std::micro>(duration).count();
+    std::lock_guard<std::mutex> lock(traceMutex_);
+    const uint32_t laneIndex = uint32_t(std::find(lanes_.begin(), lanes_.end(), lane) - lanes_.begin());
+    if (laneIndex == lanes_.size()) lanes_.push_back(lane);
+    if (events_.size() == maxTraceEvents_) events_.pop_front();
+    events_.push_back({laneIndex, name, startUs, durationUs, frame});
+}
+
+void Telemetry::writeTrace(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) throw std::runtime_error("Telemetry: cannot create " + path);
+    auto quoted = [](const std::string& s) {
+        std::string q = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') q += '\\';
+            q += c;
+        }
+        return q + '"';
+    };
+
+    std::lock_guard<std::mutex> lock(traceMutex_);
+    // Complete ("X") events, one tid per lane; the metadata events name the rows
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    const char* sep = "\n";
+    for (size_t i = 0; i < lanes_.size(); ++i, sep = ",\n") {
+        out << sep << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << i + 1 << ",\"name\":\"thread_name\",\"args\":{\"name\":"
+            << quoted(lanes_[i]) << "}}";
+    }
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for (const Event& e : events_) {
+        out << sep << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << e.lane + 1 << ",\"name\":" << quoted(e.name)
+            << ",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs;
+        if (e.frame >= 0) out << ",\"args\":{\"frame\":" << e.frame << '}';
+        out << '}';
+        sep = ",\n";
+    }
+    out << "\n]}\n";
+    if (!out) throw std::runtime_error("Telemetry: writing " + path + " failed");
+}
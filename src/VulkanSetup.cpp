@@ -32,11 +32,42 @@ bool VulkanSetup::hasLayer(const std::vector<VkLayerProperties>& list, const cha
     return false;
 }
 
+// Higher is better, -1 = unusable (no compute queue family). Device type dominates,
+// then device-local memory and shared memory size break ties between GPUs of a kind.
+int64_t VulkanSetup::scoreDevice(VkPhysicalDevice dev) {
+    uint32_t qCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(dev, &qCount, nullptr);
+    std::vector<VkQueueFamilyProperties> qprops(qCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(dev, &qCount, qprops.data());
+    bool compute = false;
+    for (const auto& q : qprops) compute = compute || (q.queueFlags & VK_QUEUE_COMPUTE_BIT);
+    if (!compute) return -1;
+
+    VkPhysicalDeviceProperties props{ };
+    vkGetPhysicalDeviceProperties(dev, &props);
+    int64_t typeRank = 0;
+    switch (props.deviceType) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   typeRank = 4; break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: typeRank = 3; break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    typeRank = 2; break;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:            typeRank = 1; break;
+        default: break;
+    }
+
+    VkPhysicalDeviceMemoryProperties mem{ };
+    vkGetPhysicalDeviceMemoryProperties(dev, &mem);
+    VkDeviceSize localBytes = 0;
+    for (uint32_t i = 0; i < mem.memoryHeapCount; ++i) {
+        if (mem.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) localBytes += mem.memoryHeaps[i].size;
+    }
+    return (typeRank << 40) + int64_t(localBytes >> 20) + int64_t(props.limits.maxComputeSharedMemorySize >> 10);
+}
+
 // --- Lifecycle -------------------------------------------------------------
 
 VulkanSetup::VulkanSetup(const Options& opts) {
     createInstance(opts);
-    pickPhysicalDeviceAndQueue();
+    pickPhysicalDeviceAndQueue(opts);
     createDeviceAndQueue();
 }
 
@@ -64,13 +95,23 @@ VulkanSetup& VulkanSetup::operator=(VulkanSetup&& o) noexcept {
     computeQueueFamilyIndex_ = o.computeQueueFamilyIndex_;
     device_ = o.device_;
     computeQueue_ = o.computeQueue_;
+    transferQueueFamilyIndex_ = o.transferQueueFamilyIndex_;
+    transferQueue_ = o.transferQueue_;
+    asyncComputeQueueFamilyIndex_ = o.asyncComputeQueueFamilyIndex_;
+    asyncComputeQueue_ = o.asyncComputeQueue_;
+    deviceName_ = std::move(o.deviceName_);
     portabilityEnabled_ = o.portabilityEnabled_;
+    enabledFeatures_ = o.enabledFeatures_;
+    apiVersion_ = o.apiVersion_;
+    hostImportAlignment_ = o.hostImportAlignment_;
 
     // Null out source
     o.instance_ = VK_NULL_HANDLE;
     o.physicalDevice_ = VK_NULL_HANDLE;
     o.device_ = VK_NULL_HANDLE;
     o.computeQueue_ = VK_NULL_HANDLE;
+    o.transferQueue_ = VK_NULL_HANDLE;
+    o.asyncComputeQueue_ = VK_NULL_HANDLE;
     return *this;
 }
 
@@ -116,6 +157,7 @@ void VulkanSetup::createInstance(const Options& opts) {
     appInfo.pEngineName = "NoEngine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.apiVersion = opts.apiVersion;
+    apiVersion_ = opts.apiVersion;
 
     VkInstanceCreateInfo ci{ };
     ci.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -132,7 +174,7 @@ void VulkanSetup::createInstance(const Options& opts) {
     vkCheck(vkCreateInstance(&ci, nullptr, &instance_), "vkCreateInstance");
 }
 
-void VulkanSetup::pickPhysicalDeviceAndQueue() {
+void VulkanSetup::pickPhysicalDeviceAndQueue(const Options& opts) {
     uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices(instance_, &deviceCount, nullptr);
     if (deviceCount == 0) throw std::runtime_error("No Vulkan-capable devices found.");
@@ -140,22 +182,55 @@ void VulkanSetup::pickPhysicalDeviceAndQueue() {
     std::vector<VkPhysicalDevice> devices(deviceCount);
     vkEnumeratePhysicalDevices(instance_, &deviceCount, devices.data());
 
-    for (auto dev : devices) {
-        // Find a compute queue family
-        uint32_t qCount = 0;
-        vkGetPhysicalDeviceQueueFamilyProperties(dev, &qCount, nullptr);
-        std::vector<VkQueueFamilyProperties> qprops(qCount);
-        vkGetPhysicalDeviceQueueFamilyProperties(dev, &qCount, qprops.data());
-
-        for (uint32_t i = 0; i < qCount; ++i) {
-            if (qprops[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
-                physicalDevice_ = dev;
-                computeQueueFamilyIndex_ = i;
-                return;
-            }
+    if (opts.deviceIndex >= 0) {
+        if (uint32_t(opts.deviceIndex) >= deviceCount || scoreDevice(devices[opts.deviceIndex]) < 0) {
+            throw std::runtime_error("Device " + std::to_string(opts.deviceIndex) + " does not exist or has no compute queue.");
+        }
+        physicalDevice_ = devices[opts.deviceIndex];
+    } else {
+        int64_t best = -1;
+        for (auto dev : devices) {
+            const int64_t score = scoreDevice(dev);
+            if (score > best) { best = score; physicalDevice_ = dev; }
+        }
+        if (best < 0) throw std::runtime_error("No device with a compute-capable queue family found.");
+    }
+
+    VkPhysicalDeviceProperties props{ };
+    vkGetPhysicalDeviceProperties(physicalDevice_, &props);
+    deviceName_ = props.deviceName;
+
+    uint32_t qCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice_, &qCount, nullptr);
+    std::vector<VkQueueFamilyProperties> qprops(qCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice_, &qCount, qprops.data());
+
+    // Main queue: first compute-capable family, as before
+    for (uint32_t i = 0; i < qCount; ++i) {
+        if (qprops[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
+            computeQueueFamilyIndex_ = i;
+            break;
+        }
+    }
+    transferQueueFamilyIndex_ = computeQueueFamilyIndex_;
+    asyncComputeQueueFamilyIndex_ = computeQueueFamilyIndex_;
+    if (!opts.dedicatedQueues) return;
+
+    // Transfer-only families are the DMA engines of discrete GPUs; compute-only
+    // families run alongside the graphics/compute family
+    const VkQueueFlags gc = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+    for (uint32_t i = 0; i < qCount; ++i) {
+        if ((qprops[i].queueFlags & VK_QUEUE_TRANSFER_BIT) && !(qprops[i].queueFlags & gc)) {
+            transferQueueFamilyIndex_ = i;
+            break;
+        }
+    }
+    for (uint32_t i = 0; i < qCount; ++i) {
+        if (i != computeQueueFamilyIndex_ && (qprops[i].queueFlags & gc) == VK_QUEUE_COMPUTE_BIT) {
+            asyncComputeQueueFamilyIndex_ = i;
+            break;
         }
     }
-    throw std::runtime_error("No device with a compute-capable queue family found.");
 }
 
 void VulkanSetup::createDeviceAndQueue() {
@@ -170,23 +245,54 @@ void VulkanSetup::createDeviceAndQueue() {
         enabledDevExts.push_back("VK_KHR_portability_subset");
     }
 
+    // Host pointer import for zero-copy uploads. Its dependencies (external memory,
+    // properties2) are core in 1.1, so only offer it when instance and device are 1.1+.
+    VkPhysicalDeviceProperties props{ };
+    vkGetPhysicalDeviceProperties(physicalDevice_, &props);
+    if (apiVersion_ >= VK_API_VERSION_1_1 && props.apiVersion >= VK_API_VERSION_1_1 &&
+        hasExtension(devExts, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME)) {
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProps{ };
+        hostProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 props2{ };
+        props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        props2.pNext = &hostProps;
+        vkGetPhysicalDeviceProperties2(physicalDevice_, &props2);
+        enabledDevExts.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+        hostImportAlignment_ = hostProps.minImportedHostPointerAlignment;
+    }
+
+    // One queue per distinct family
     float priority = 1.0f;
-    VkDeviceQueueCreateInfo qci{ };
-    qci.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    qci.queueFamilyIndex = computeQueueFamilyIndex_;
-    qci.queueCount = 1;
-    qci.pQueuePriorities = &priority;
+    std::vector<VkDeviceQueueCreateInfo> queueInfos;
+    for (uint32_t family : {computeQueueFamilyIndex_, transferQueueFamilyIndex_, asyncComputeQueueFamilyIndex_}) {
+        bool seen = false;
+        for (const auto& q : queueInfos) seen = seen || q.queueFamilyIndex == family;
+        if (seen) continue;
+        VkDeviceQueueCreateInfo qci{ };
+        qci.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        qci.queueFamilyIndex = family;
+        qci.queueCount = 1;
+        qci.pQueuePriorities = &priority;
+        queueInfos.push_back(qci);
+    }
 
-    VkPhysicalDeviceFeatures features{ }; // default; add features if needed
+    // Only enable what the kernels need: r8/r8ui storage images are "extended" formats
+    VkPhysicalDeviceFeatures supported{ };
+    vkGetPhysicalDeviceFeatures(physicalDevice_, &supported);
+    VkPhysicalDeviceFeatures features{ };
+    features.shaderStorageImageExtendedFormats = supported.shaderStorageImageExtendedFormats;
 
     VkDeviceCreateInfo dci{ };
     dci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    dci.queueCreateInfoCount = 1;
-    dci.pQueueCreateInfos = &qci;
+    dci.queueCreateInfoCount = static_cast<uint32_t>(queueInfos.size());
+    dci.pQueueCreateInfos = queueInfos.data();
     dci.pEnabledFeatures = &features;
     dci.enabledExtensionCount = static_cast<uint32_t>(enabledDevExts.size());
     dci.ppEnabledExtensionNames = enabledDevExts.empty() ? nullptr : enabledDevExts.data();
 
     vkCheck(vkCreateDevice(physicalDevice_, &dci, nullptr, &device_), "vkCreateDevice");
+    enabledFeatures_ = features;
     vkGetDeviceQueue(device_, computeQueueFamilyIndex_, 0, &computeQueue_);
+    vkGetDeviceQueue(device_, transferQueueFamilyIndex_, 0, &transferQueue_);
+    vkGetDeviceQueue(device_, asyncComputeQueueFamilyIndex_, 0, &asyncComputeQueue_);
 }
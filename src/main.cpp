@@ -2,345 +2,437 @@
 #include <opencv2/features2d.hpp>
 #include <vulkan/vulkan.h>
 #include <iostream>
-#include <vector>
-#include <cassert>
 #include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
 #include "VulkanSetup.h"
-#include <chrono> 
-
-static void VK_CHECK(VkResult r, const char* where) {
-    if (r != VK_SUCCESS) throw std::runtime_error(std::string("Vulkan error at ") + where + " (" + std::to_string(r) + ")");
-}
-// Fehlende Hilfsfunktionen hinzufügen:
-static uint32_t findMemoryType(uint32_t typeFilter, VkPhysicalDevice physDevice, VkMemoryPropertyFlags properties) {
-    VkPhysicalDeviceMemoryProperties memProps;
-    vkGetPhysicalDeviceMemoryProperties(physDevice, &memProps);
-    for (uint32_t i = 0; i < memProps.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
+#include "FastDetector.h"
+#include "CpuFastDetector.h"
+#include "FrameSource.h"
+#include "KeypointStream.h"
+#include "Telemetry.h"
+#include <chrono>
+#include <memory>
+#include <tuple>
+
+int main(int argc, char** argv) {
+    // --overlay: additionally draw the keypoints on the GPU and write out.png (debug only)
+    // --png: write out_CPU.png with the cv::FAST keypoints (debug only, PNG encoding is slow)
+    // --keypoints=FILE: write the keypoints (+ ORB descriptors) of the image or --input sequence as .kps, see tools/kps_dump
+    // --format=r8ui|r8|rgba8: GPU input format (r8ui uploads the grayscale bytes as-is)
+    // --tiled: shared-memory tiled kernel, --wg=WxH: FAST workgroup size (default 16x16)
+    // --nms: GPU 3x3 non-maximum suppression on the FAST score before compaction
+    // --inflight=K: frame slots for streaming, --repeat=N: stream the image N times and report fps
+    // --batch=B: additionally detect B copies of the image as one array-layer batch
+    // --grid=C[xK]: keep the best K (default 4) corners per CxC cell on the GPU
+    // --levels=L, --scale=S: GPU image pyramid with L levels, each S times smaller (default 2)
+    // --backend=auto|gpu|cpu: auto falls back to the CPU backend without a Vulkan device
+    // --threads=T: CPU backend threads (default: all), --compare: also run the CPU backend and diff
+    // --pattern=9_16|7_12|5_8, --threshold=T: segment test of both backends and cv::FAST (default 9_16, 76)
+    // --target=N: with --repeat on the GPU, adapt the threshold per frame towards N keypoints
+    // --shaders=DIR: load *.spv from DIR instead of the embedded copies
+    // --pipeline-cache=FILE: VkPipelineCache file (default fast_pipelines.cache, empty = off)
+    // --orb: GPU ORB orientation + descriptors, checked against cv::ORB on the same keypoints
+    // --mask=FILE: GPU FAST only on the workgroup tiles under nonzero pixels of FILE (indirect dispatch)
+    // --track[=N]: GPU KLT of up to N (default 1024) keypoints into a shifted copy, checked against cv::calcOpticalFlowPyrLK
+    // --image=PATH: single test image (default: church.jpg; skipped if only --input is given)
+    // --input=PATH: stream a sequence (.y8 file, image directory, .txt list) through the detector, after --image if both are given
+    // --decode-threads=T, --prefetch=N: image decoders and frames decoded ahead (default: all cores, 2x decoders)
+    // --write-y8=FILE: convert --input to a raw .y8 sequence and exit
+    // --device=N: Vulkan device index (default: best scored, discrete GPUs first)
+    // --dedicated-queues: upload on a transfer-only queue, --async-compute: detect on a compute-only queue
+    // --metrics[=FILE]: GPU detector metrics in Prometheus text format at exit (stdout or FILE)
+    // --trace=FILE: Chrome trace JSON of the host and GPU stages of every GPU frame (chrome://tracing)
+    FastDetector::Options detOpts;
+    detOpts.pipelineCache = "fast_pipelines.cache";
+    int repeat = 0;
+    int batch = 0;
+    int target = 0;
+    std::string backend = "auto";
+    unsigned threads = 0;
+    bool compare = false;
+    int device = -1;
+    bool dedicatedQueues = false;
+    std::string imagePath, input, writeY8, keypointsOut, maskFile, metricsOut, traceOut;
+    bool metrics = false;
+    bool png = false;
+    unsigned decodeThreads = 0, prefetch = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--overlay") detOpts.debugOverlay = true;
+        else if (arg == "--tiled") detOpts.tiled = true;
+        else if (arg == "--nms") detOpts.nonmaxSuppression = true;
+        else if (arg == "--orb") detOpts.orb = true;
+        else if (arg == "--track") detOpts.maxTrackPoints = 1024;
+        else if (arg.rfind("--track=", 0) == 0) detOpts.maxTrackPoints = uint32_t(std::max(1, std::atoi(arg.c_str() + 8)));
+        else if (arg.rfind("--format=", 0) == 0) {
+            std::string f = arg.substr(9);
+            if (f == "r8ui") detOpts.inputFormat = FastDetector::InputFormat::R8UInt;
+            else if (f == "r8") detOpts.inputFormat = FastDetector::InputFormat::R8UNorm;
+            else if (f == "rgba8") detOpts.inputFormat = FastDetector::InputFormat::RGBA8;
+            else std::cerr << "Unknown " << arg << ", using r8ui" << std::endl;
+        }
+        else if (arg.rfind("--inflight=", 0) == 0) detOpts.framesInFlight = uint32_t(std::max(1, std::atoi(arg.c_str() + 11)));
+        else if (arg.rfind("--repeat=", 0) == 0) repeat = std::max(0, std::atoi(arg.c_str() + 9));
+        else if (arg.rfind("--grid=", 0) == 0) {
+            if (std::sscanf(arg.c_str() + 7, "%ux%u", &detOpts.gridCell, &detOpts.gridTopK) < 1) {
+                std::cerr << "Invalid " << arg << ", expected --grid=C or --grid=CxK" << std::endl;
+                return -1;
+            }
+        }
+        else if (arg.rfind("--levels=", 0) == 0) detOpts.pyramidLevels = uint32_t(std::max(1, std::atoi(arg.c_str() + 9)));
+        else if (arg.rfind("--scale=", 0) == 0) detOpts.pyramidScale = std::strtof(arg.c_str() + 8, nullptr);
+        else if (arg.rfind("--backend=", 0) == 0) backend = arg.substr(10);
+        else if (arg.rfind("--threads=", 0) == 0) threads = unsigned(std::max(0, std::atoi(arg.c_str() + 10)));
+        else if (arg == "--compare") compare = true;
+        else if (arg.rfind("--target=", 0) == 0) target = std::max(0, std::atoi(arg.c_str() + 9));
+        else if (arg.rfind("--threshold=", 0) == 0) detOpts.threshold = uint32_t(std::max(0, std::atoi(arg.c_str() + 12)));
+        else if (arg.rfind("--pattern=", 0) == 0) {
+            std::string p = arg.substr(10);
+            if (p == "9_16") detOpts.pattern = FastPattern::Fast9_16;
+            else if (p == "7_12") detOpts.pattern = FastPattern::Fast7_12;
+            else if (p == "5_8") detOpts.pattern = FastPattern::Fast5_8;
+            else std::cerr << "Unknown " << arg << ", using 9_16" << std::endl;
+        }
+        else if (arg.rfind("--shaders=", 0) == 0) detOpts.shaderDir = arg.substr(10);
+        else if (arg.rfind("--pipeline-cache=", 0) == 0) detOpts.pipelineCache = arg.substr(17);
+        else if (arg.rfind("--device=", 0) == 0) device = std::atoi(arg.c_str() + 9);
+        else if (arg == "--dedicated-queues") dedicatedQueues = true;
+        else if (arg == "--async-compute") { dedicatedQueues = true; detOpts.asyncCompute = true; }
+        else if (arg == "--png") png = true;
+        else if (arg.rfind("--keypoints=", 0) == 0) keypointsOut = arg.substr(12);
+        else if (arg.rfind("--mask=", 0) == 0) { maskFile = arg.substr(7); detOpts.tileMask = true; }
+        else if (arg == "--metrics") metrics = true;
+        else if (arg.rfind("--metrics=", 0) == 0) { metrics = true; metricsOut = arg.substr(10); }
+        else if (arg.rfind("--trace=", 0) == 0) traceOut = arg.substr(8);
+        else if (arg.rfind("--image=", 0) == 0) imagePath = arg.substr(8);
+        else if (arg.rfind("--input=", 0) == 0) input = arg.substr(8);
+        else if (arg.rfind("--write-y8=", 0) == 0) writeY8 = arg.substr(11);
+        else if (arg.rfind("--decode-threads=", 0) == 0) decodeThreads = unsigned(std::max(0, std::atoi(arg.c_str() + 17)));
+        else if (arg.rfind("--prefetch=", 0) == 0) prefetch = unsigned(std::max(0, std::atoi(arg.c_str() + 11)));
+        else if (arg.rfind("--batch=", 0) == 0) batch = std::max(0, std::atoi(arg.c_str() + 8));
+        else if (arg.rfind("--wg=", 0) == 0) {
+            if (std::sscanf(arg.c_str() + 5, "%ux%u", &detOpts.workgroupX, &detOpts.workgroupY) != 2) {
+                std::cerr << "Invalid " << arg << ", expected --wg=WxH" << std::endl;
+                return -1;
+            }
         }
     }
-    throw std::runtime_error("Failed to find suitable memory type!");
-}
-
-static std::vector<char> readFile(const std::string& filename) {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("failed to open file: " + filename);
-    }
-    size_t fileSize = (size_t) file.tellg();
-    std::vector<char> buffer(fileSize);
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
-    return buffer;
-}
-
-
-int main() {
-    auto beginOneShot = [&](VkDevice dev, VkCommandPool pool) -> VkCommandBuffer {
-        VkCommandBufferAllocateInfo ai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
-        ai.commandPool = pool; ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; ai.commandBufferCount = 1;
-        VkCommandBuffer cmd{};
-        VK_CHECK(vkAllocateCommandBuffers(dev, &ai, &cmd), "vkAllocateCommandBuffers");
-        VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-        bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        VK_CHECK(vkBeginCommandBuffer(cmd, &bi), "vkBeginCommandBuffer");
-        return cmd;
-    };
-    auto endOneShot = [&](VkDevice dev, VkQueue q, VkCommandPool pool, VkCommandBuffer cmd) {
-        VK_CHECK(vkEndCommandBuffer(cmd), "vkEndCommandBuffer");
-        VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO}; si.commandBufferCount = 1; si.pCommandBuffers = &cmd;
-        VK_CHECK(vkQueueSubmit(q, 1, &si, VK_NULL_HANDLE), "vkQueueSubmit");
-        VK_CHECK(vkQueueWaitIdle(q), "vkQueueWaitIdle");
-        vkFreeCommandBuffers(dev, pool, 1, &cmd);
-    };
-    auto transitionImage = [&](VkCommandBuffer cmd, VkImage img,
-                               VkImageLayout oldL, VkImageLayout newL,
-                               VkAccessFlags srcAccess, VkAccessFlags dstAccess,
-                               VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
-        VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
-        b.oldLayout = oldL; b.newLayout = newL;
-        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        b.image = img;
-        b.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
-        b.srcAccessMask = srcAccess; b.dstAccessMask = dstAccess;
-        vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &b);
-    };
-
-    // Schritt 1: VulkanSetup initialisieren
-    VulkanSetup::Options opts;
-    opts.appName = "ComputeShaderExample";
-    opts.apiVersion = VK_API_VERSION_1_2;
-    opts.enableValidation = true; 
-    VulkanSetup vk(opts);
-
-    // Command pool
-    VkCommandPoolCreateInfo poolCI{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
-    poolCI.queueFamilyIndex = vk.computeQueueFamily();
-    poolCI.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    VkCommandPool cmdPool{};
-    VK_CHECK(vkCreateCommandPool(vk.device(), &poolCI, nullptr, &cmdPool), "vkCreateCommandPool");
 
-    //Get local image to perform FAST
-    cv::Mat image = cv::imread("/Users/olehoffmann/Documents/TUM/Studium/4. Semester/Guided Research/Coding/Vulkan Feature Extraction/Images/church.jpg", cv::IMREAD_GRAYSCALE);
-    cv::Mat gray = image;
-    if (image.empty()) {
-        std::cerr << "Fehler beim Laden des Bildes!" << std::endl;
-        return -1;
+    // Conversion only: decode --input once and store it as raw Y8 frames
+    if (!writeY8.empty()) {
+        if (input.empty()) {
+            std::cerr << "--write-y8 needs --input" << std::endl;
+            return -1;
+        }
+        auto source = FrameSource::open(input, decodeThreads, prefetch);
+        std::unique_ptr<Y8Writer> writer;
+        auto t0 = std::chrono::steady_clock::now();
+        for (cv::Mat frame = source->next(); !frame.empty(); frame = source->next()) {
+            if (!writer) writer = std::make_unique<Y8Writer>(writeY8, uint32_t(frame.cols), uint32_t(frame.rows));
+            writer->append(frame);
+        }
+        if (!writer) {
+            std::cerr << "No frames in " << input << std::endl;
+            return -1;
+        }
+        writer->close();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << "Wrote " << writer->frameCount() << " frames to " << writeY8 << " in " << sec << " s\n";
+        return 0;
     }
-    std::cout << "Bildgröße: " << image.cols << "x" << image.rows << std::endl;
-    if(image.channels() == 3) cv::cvtColor(image, image, cv::COLOR_BGR2RGBA);
-    else if(image.channels() == 1) cv::cvtColor(image, image, cv::COLOR_GRAY2RGBA);
 
-    //Run FAST with CPU 
-    int threshold = 76;
-    bool nonmaxSuppression = false;
-    std::vector<cv::KeyPoint> kps;
-    cv::FAST(gray, kps, threshold, nonmaxSuppression, cv::FastFeatureDetector::TYPE_9_16);
-    
-    cv::Mat color;
-    cv::cvtColor(gray, color, cv::COLOR_GRAY2BGR);
-    const int radius = 6;
-    const cv::Scalar red(0, 0, 255); // BGR
-    for (const auto& kp : kps) {
-        cv::Point center(cvRound(kp.pt.x), cvRound(kp.pt.y));
-        cv::circle(color, center, radius, red, 2, cv::LINE_AA); // thickness=2 ring
-    }
-    if (!cv::imwrite("out_CPU.png", color)) {
-        std::cerr << "Konnte out_CPU.png nicht speichern!" << std::endl;
-        return -1;
+    // Schritt 1: VulkanSetup initialisieren (nicht mit --backend=cpu)
+    std::unique_ptr<VulkanSetup> vk;
+    if (backend != "cpu") {
+        VulkanSetup::Options opts;
+        opts.appName = "ComputeShaderExample";
+        opts.apiVersion = VK_API_VERSION_1_2;
+        opts.enableValidation = true;
+        opts.deviceIndex = device;
+        opts.dedicatedQueues = dedicatedQueues;
+        try {
+            vk = std::make_unique<VulkanSetup>(opts);
+            std::cout << "Device: " << vk->deviceName()
+                      << (vk->transferQueueFamily() != vk->computeQueueFamily() ? ", dedicated transfer queue" : "")
+                      << (vk->asyncComputeQueueFamily() != vk->computeQueueFamily() ? ", async compute queue" : "")
+                      << std::endl;
+        } catch (const std::exception& e) {
+            if (backend == "gpu") throw;
+            std::cerr << "No usable Vulkan device (" << e.what() << "), using the CPU backend" << std::endl;
+        }
     }
 
-
-    uint32_t width = image.cols;
-    uint32_t height = image.rows;
-    VkDeviceSize imageSize = width * height * 4; 
-    VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
-
-    auto createImage = [&](VkImage& image, VkDeviceMemory& mem) {
-        VkImageCreateInfo ici{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
-        ici.imageType = VK_IMAGE_TYPE_2D;
-        ici.extent = {width, height, 1};
-        ici.mipLevels = 1; ici.arrayLayers = 1;
-        ici.format = format;
-        ici.tiling = VK_IMAGE_TILING_OPTIMAL;
-        ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        ici.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-        ici.samples = VK_SAMPLE_COUNT_1_BIT; ici.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        VK_CHECK(vkCreateImage(vk.device(), &ici, nullptr, &image), "vkCreateImage");
-        VkMemoryRequirements mr{}; vkGetImageMemoryRequirements(vk.device(), image, &mr);
-        VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-        mai.allocationSize = mr.size;
-        mai.memoryTypeIndex = findMemoryType(mr.memoryTypeBits, vk.physicalDevice(), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-        VK_CHECK(vkAllocateMemory(vk.device(), &mai, nullptr, &mem), "vkAllocateMemory(image)");
-        VK_CHECK(vkBindImageMemory(vk.device(), image, mem, 0), "vkBindImageMemory");
-    };
-
-    auto makeView = [&](VkImage img)->VkImageView{
-        VkImageViewCreateInfo iv{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
-        iv.image = img; iv.viewType = VK_IMAGE_VIEW_TYPE_2D; iv.format = format;
-        iv.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0,1,0,1};
-        VkImageView v{}; VK_CHECK(vkCreateImageView(vk.device(), &iv, nullptr, &v), "vkCreateImageView");
-        return v;
-    };
-
-    //4. Create input and output images
-    VkImage inImage{}, outImage{};
-    VkDeviceMemory inMem{}, outMem{};
-    createImage(inImage, inMem);
-    createImage(outImage, outMem);
-    VkImageView inView = makeView(inImage);
-    VkImageView outView = makeView(outImage);
-
-    //5. Staging buffer & upload to inImage
-    VkBuffer staging{}; 
-    VkDeviceMemory stagingMem{};
-    {
-        VkBufferCreateInfo bi{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-        bi.size = imageSize; 
-        bi.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        VK_CHECK(vkCreateBuffer(vk.device(), &bi, nullptr, &staging), "vkCreateBuffer(staging)");
-        VkMemoryRequirements mr{}; vkGetBufferMemoryRequirements(vk.device(), staging, &mr);
-        VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-        mai.allocationSize = mr.size;
-        mai.memoryTypeIndex = findMemoryType(mr.memoryTypeBits, vk.physicalDevice(),
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        VK_CHECK(vkAllocateMemory(vk.device(), &mai, nullptr, &stagingMem), "vkAllocateMemory(staging)");
-        VK_CHECK(vkBindBufferMemory(vk.device(), staging, stagingMem, 0), "vkBindBufferMemory(staging)");
-        void* mapped = nullptr;
-        VK_CHECK(vkMapMemory(vk.device(), stagingMem, 0, imageSize, 0, &mapped), "vkMapMemory");
-        std::memcpy(mapped, image.data, (size_t)imageSize);
-        vkUnmapMemory(vk.device(), stagingMem);
+    // The CPU backend follows the same detection options
+    CpuFastDetector::Options cpuOpts;
+    cpuOpts.threads = threads;
+    cpuOpts.pattern = detOpts.pattern;
+    cpuOpts.threshold = detOpts.threshold;
+    cpuOpts.nonmaxSuppression = detOpts.nonmaxSuppression;
+    cpuOpts.gridCell = detOpts.gridCell;
+    cpuOpts.gridTopK = detOpts.gridTopK;
+    cpuOpts.maxKeypoints = detOpts.maxKeypoints;
+    cpuOpts.pyramidLevels = detOpts.pyramidLevels;
+    cpuOpts.pyramidScale = detOpts.pyramidScale;
+
+    // Single image: --image, or the default test image unless only an --input sequence is given
+    cv::Mat gray;
+    if (!imagePath.empty() || input.empty()) {
+        if (imagePath.empty()) imagePath = "/Users/olehoffmann/Documents/TUM/Studium/4. Semester/Guided Research/Coding/Vulkan Feature Extraction/Images/church.jpg";
+        gray = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
+        if (gray.empty()) {
+            std::cerr << "Fehler beim Laden des Bildes " << imagePath << "!" << std::endl;
+            return -1;
+        }
+        std::cout << "Bildgröße: " << gray.cols << "x" << gray.rows << std::endl;
     }
 
-    {
-        VkCommandBuffer cmd = beginOneShot(vk.device(), cmdPool);
-        transitionImage(cmd, inImage,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            0, VK_ACCESS_TRANSFER_WRITE_BIT,
-            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
-
-        VkBufferImageCopy region{};
-        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
-        region.imageOffset = {0,0,0};
-        region.imageExtent = {width, height, 1};
-        vkCmdCopyBufferToImage(cmd, staging, inImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-        transitionImage(cmd, inImage,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
-            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
-
-        // outImage ready for compute writes
-        transitionImage(cmd, outImage,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
-            0, VK_ACCESS_SHADER_WRITE_BIT,
-            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
-
-        endOneShot(vk.device(), vk.computeQueue(), cmdPool, cmd);
+    // Run FAST; the detector keeps its pipelines and buffers for further frames
+    std::unique_ptr<Telemetry> telemetry;   // outlives gpu
+    std::unique_ptr<FastDetector> gpu;
+    std::unique_ptr<CpuFastDetector> cpu;
+    Detector* detector = nullptr;
+    if (vk) {
+        if (metrics || !traceOut.empty()) {
+            telemetry = std::make_unique<Telemetry>(traceOut.empty() ? 0 : size_t(1) << 16);
+            detOpts.telemetry = telemetry.get();
+        }
+        gpu = std::make_unique<FastDetector>(*vk, detOpts);
+        detector = gpu.get();
+        if (!maskFile.empty()) {
+            cv::Mat mask = cv::imread(maskFile, cv::IMREAD_GRAYSCALE);
+            if (mask.empty() || (!gray.empty() && mask.size() != gray.size())) {
+                std::cerr << "Mask " << maskFile << " is missing or does not match the image size" << std::endl;
+                return -1;
+            }
+            gpu->setDetectionMask(mask);
+        }
+    } else {
+        if (!maskFile.empty()) std::cerr << "--mask only applies to the GPU backend" << std::endl;
+        if (metrics || !traceOut.empty()) std::cerr << "--metrics/--trace only apply to the GPU backend" << std::endl;
+        cpu = std::make_unique<CpuFastDetector>(cpuOpts);
+        detector = cpu.get();
+        std::cout << "CPU backend: " << cpu->simd() << ", " << cpu->threads() << " threads\n";
     }
 
-    // ----- 8) Descriptors: binding 0 = in, 1 = out -----
-    VkDescriptorSetLayoutBinding b0{}; b0.binding = 0; b0.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; b0.descriptorCount = 1; b0.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    VkDescriptorSetLayoutBinding b1{}; b1.binding = 1; b1.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; b1.descriptorCount = 1; b1.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    VkDescriptorSetLayoutBinding bindings[2] = {b0, b1};
-
-    VkDescriptorSetLayoutCreateInfo dlci{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-    dlci.bindingCount = 2; dlci.pBindings = bindings;
-    VkDescriptorSetLayout dsl{};
-    VK_CHECK(vkCreateDescriptorSetLayout(vk.device(), &dlci, nullptr, &dsl), "vkCreateDescriptorSetLayout");
-
-    VkDescriptorPoolSize poolSizes[1] = {{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2}};
-    VkDescriptorPoolCreateInfo dpci{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
-    dpci.poolSizeCount = 1; dpci.pPoolSizes = poolSizes; dpci.maxSets = 1;
-    VkDescriptorPool dpool{};
-    VK_CHECK(vkCreateDescriptorPool(vk.device(), &dpci, nullptr, &dpool), "vkCreateDescriptorPool");
-
-    VkDescriptorSetAllocateInfo dsai{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    dsai.descriptorPool = dpool; dsai.descriptorSetCount = 1; dsai.pSetLayouts = &dsl;
-    VkDescriptorSet dset{};
-    VK_CHECK(vkAllocateDescriptorSets(vk.device(), &dsai, &dset), "vkAllocateDescriptorSets");
-
-    VkDescriptorImageInfo inInfo{};  inInfo.imageView = inView;   inInfo.imageLayout  = VK_IMAGE_LAYOUT_GENERAL;
-    VkDescriptorImageInfo outInfo{}; outInfo.imageView = outView; outInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-
-    VkWriteDescriptorSet writes[2]{};
-    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[0].dstSet = dset; writes[0].dstBinding = 0; writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; writes[0].descriptorCount = 1; writes[0].pImageInfo = &inInfo;
-    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[1].dstSet = dset; writes[1].dstBinding = 1; writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; writes[1].descriptorCount = 1; writes[1].pImageInfo = &outInfo;
-    vkUpdateDescriptorSets(vk.device(), 2, writes, 0, nullptr);
+    // Keypoint stream: the --input sequence if there is one, otherwise this image
+    const bool withDescriptors = gpu && detOpts.orb;
+    std::unique_ptr<KeypointWriter> writer;
+    if (!keypointsOut.empty()) writer = std::make_unique<KeypointWriter>(keypointsOut, withDescriptors ? 32 : 0);
+
+    if (!gray.empty()) {
+        //Run FAST with CPU
+        int threshold = int(detOpts.threshold);
+        bool nonmaxSuppression = detOpts.nonmaxSuppression;
+        const int cvType = detOpts.pattern == FastPattern::Fast5_8 ? cv::FastFeatureDetector::TYPE_5_8
+                         : detOpts.pattern == FastPattern::Fast7_12 ? cv::FastFeatureDetector::TYPE_7_12
+                         : cv::FastFeatureDetector::TYPE_9_16;
+        std::vector<cv::KeyPoint> kps;
+        cv::FAST(gray, kps, threshold, nonmaxSuppression, cvType);
+
+        if (png) {
+            cv::Mat color;
+            cv::cvtColor(gray, color, cv::COLOR_GRAY2BGR);
+            const int radius = 6;
+            const cv::Scalar red(0, 0, 255); // BGR
+            for (const auto& kp : kps) {
+                cv::Point center(cvRound(kp.pt.x), cvRound(kp.pt.y));
+                cv::circle(color, center, radius, red, 2, cv::LINE_AA); // thickness=2 ring
+            }
+            if (!cv::imwrite("out_CPU.png", color)) {
+                std::cerr << "Konnte out_CPU.png nicht speichern!" << std::endl;
+                return -1;
+            }
+        }
 
-        // ----- 9) Pipeline (load comp.spv) -----
-    auto code = readFile("/Users/olehoffmann/Documents/TUM/Studium/4. Semester/Guided Research/Coding/Vulkan Feature Extraction/build/shaders/comp.spv");
-    VkShaderModuleCreateInfo smci{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
-    smci.codeSize = code.size();
-    smci.pCode = reinterpret_cast<const uint32_t*>(code.data());
-    VkShaderModule sm{};
-    VK_CHECK(vkCreateShaderModule(vk.device(), &smci, nullptr, &sm), "vkCreateShaderModule");
+        std::vector<Keypoint> gpuKps = detector->detect(gray);
+        if (writer && input.empty()) writer->append(gpuKps, withDescriptors ? gpu->descriptors() : cv::Mat());
+        std::cout << detector->name() << " keypoints: " << gpuKps.size() << " (cv::FAST: " << kps.size() << ")\n";
+        if (detOpts.pyramidLevels > 1) {
+            std::vector<size_t> perLevel(detOpts.pyramidLevels, 0);
+            for (const Keypoint& kp : gpuKps) ++perLevel[kp.level];
+            for (size_t l = 0; l < perLevel.size(); ++l)
+                std::cout << "  level " << l << " (x" << detector->levelScale(uint32_t(l)) << "): " << perLevel[l] << "\n";
+        }
 
-    VkPipelineLayoutCreateInfo plci{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
-    plci.setLayoutCount = 1; plci.pSetLayouts = &dsl;
-    VkPipelineLayout layout{};
-    VK_CHECK(vkCreatePipelineLayout(vk.device(), &plci, nullptr, &layout), "vkCreatePipelineLayout");
+        if (gpu) {
+            const MemoryAllocator::Stats mem = gpu->memoryStats();
+            std::cout << "GPU memory: " << mem.blocks << " blocks (" << (mem.blockBytes >> 20) << " MiB) + "
+                      << mem.dedicated << " dedicated, " << mem.liveAllocations << " resources, "
+                      << mem.deviceAllocations << " vkAllocateMemory calls\n";
+        }
 
-    VkComputePipelineCreateInfo cpci{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
-    cpci.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0,
-                  VK_SHADER_STAGE_COMPUTE_BIT, sm, "main"};
-    cpci.layout = layout;
-    VkPipeline pipeline{};
-    VK_CHECK(vkCreateComputePipelines(vk.device(), VK_NULL_HANDLE, 1, &cpci, nullptr, &pipeline), "vkCreateComputePipelines");
+        // cv::ORB describes the level-0 keypoints again with the GPU angles; class_id
+        // keeps the row index, since compute() drops keypoints near the border
+        if (gpu && detOpts.orb) {
+            const cv::Mat desc = gpu->descriptors();
+            const std::vector<float> angles = gpu->angles();
+            std::vector<cv::KeyPoint> cvKps;
+            for (size_t i = 0; i < gpuKps.size(); ++i) {
+                const Keypoint& k = gpuKps[i];
+                if (k.level == 0) cvKps.emplace_back(float(k.x), float(k.y), 31.0f, angles[i], k.score, 0, int(i));
+            }
+            cv::Mat cvDesc;
+            cv::ORB::create(int(detOpts.maxKeypoints), 1.2f, 1)->compute(gray, cvKps, cvDesc);
+            double bits = 0;
+            for (size_t j = 0; j < cvKps.size(); ++j) bits += cv::norm(desc.row(cvKps[j].class_id), cvDesc.row(int(j)), cv::NORM_HAMMING);
+            std::cout << "ORB: " << desc.rows << " descriptors, mean Hamming distance to cv::ORB "
+                      << (cvKps.empty() ? 0.0 : bits / double(cvKps.size())) << " bits over " << cvKps.size() << " keypoints\n";
+        }
 
-    // ----- 10) Dispatch -----
-    VkCommandBufferAllocateInfo cbi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
-    cbi.commandPool = cmdPool; cbi.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; cbi.commandBufferCount = 1;
-    VkCommandBuffer cmdBuf{};
-    VK_CHECK(vkAllocateCommandBuffers(vk.device(), &cbi, &cmdBuf), "vkAllocateCommandBuffers");
+        // KLT from the image into a copy shifted by (3, 2) pixels: the GPU tracks are
+        // compared with the true shift and with cv::calcOpticalFlowPyrLK on the same points
+        if (gpu && detOpts.maxTrackPoints > 0) {
+            const int dx = 3, dy = 2;
+            cv::Mat shifted(gray.size(), gray.type(), cv::Scalar(0));
+            gray(cv::Rect(0, 0, gray.cols - dx, gray.rows - dy)).copyTo(shifted(cv::Rect(dx, dy, gray.cols - dx, gray.rows - dy)));
+            std::vector<cv::Point2f> prevPts;
+            for (const Keypoint& k : gpuKps) {
+                if (k.level == 0 && prevPts.size() < detOpts.maxTrackPoints) prevPts.emplace_back(float(k.x), float(k.y));
+            }
+            gpu->trackPoints(prevPts);
+            gpu->detect(shifted);
+            const std::vector<FastDetector::Track> tracks = gpu->trackedPoints();
+
+            std::vector<cv::Point2f> cvPts;
+            std::vector<unsigned char> cvStatus;
+            std::vector<float> cvErr;
+            const int win = int(detOpts.trackWindow);
+            cv::calcOpticalFlowPyrLK(gray, shifted, prevPts, cvPts, cvStatus, cvErr, cv::Size(win, win),
+                                     int(detOpts.pyramidLevels) - 1);
+            size_t found = 0, both = 0;
+            double shiftErr = 0, cvDiff = 0;
+            for (size_t i = 0; i < tracks.size(); ++i) {
+                if (!tracks[i].found) continue;
+                ++found;
+                shiftErr += std::hypot(tracks[i].x - prevPts[i].x - dx, tracks[i].y - prevPts[i].y - dy);
+                if (cvStatus[i]) {
+                    ++both;
+                    cvDiff += std::hypot(tracks[i].x - cvPts[i].x, tracks[i].y - cvPts[i].y);
+                }
+            }
+            std::cout << "KLT: " << found << "/" << tracks.size() << " tracked, mean error to the true shift "
+                      << (found ? shiftErr / double(found) : 0.0) << " px, to cv::calcOpticalFlowPyrLK "
+                      << (both ? cvDiff / double(both) : 0.0) << " px over " << both << " points\n";
+        }
 
-    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    VK_CHECK(vkBeginCommandBuffer(cmdBuf, &bi), "vkBeginCommandBuffer");
+        if (gpu && detOpts.debugOverlay) {
+            cv::imwrite("out.png", gpu->overlayImage());
+            std::cout << "Wrote out.png\n";
+        }
 
-    vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
-    vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &dset, 0, nullptr);
+        // Same image through the CPU backend; both sides sorted since GPU order is arbitrary
+        if (gpu && compare) {
+            CpuFastDetector ref(cpuOpts);
+            auto t0 = std::chrono::steady_clock::now();
+            std::vector<Keypoint> cpuKps = ref.detect(gray);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            auto key = [](const Keypoint& k) { return std::make_tuple(k.layer, k.level, k.y, k.x, k.score); };
+            auto byPos = [&](const Keypoint& a, const Keypoint& b) { return key(a) < key(b); };
+            std::sort(gpuKps.begin(), gpuKps.end(), byPos);
+            std::sort(cpuKps.begin(), cpuKps.end(), byPos);
+            bool same = std::equal(gpuKps.begin(), gpuKps.end(), cpuKps.begin(), cpuKps.end(),
+                                   [&](const Keypoint& a, const Keypoint& b) { return key(a) == key(b); });
+            std::cout << "CPU backend (" << ref.simd() << ", " << ref.threads() << " threads): "
+                      << cpuKps.size() << " keypoints in " << ms << " ms, " << (same ? "identical" : "DIFFERENT")
+                      << (gpu->inputFormat() == FastDetector::InputFormat::RGBA8 ? " (rgba8 uses float luminance)" : "")
+                      << "\n";
+        }
 
-    const uint32_t lsx = 16, lsy = 16; // match shader local_size
-    uint32_t gx = (width  + lsx - 1) / lsx;
-    uint32_t gy = (height + lsy - 1) / lsy;
-    vkCmdDispatch(cmdBuf, gx, gy, 1);
+        // Batch: B same-size frames, one submission and one z-dispatch per stage
+        if (batch > 0) {
+            std::vector<cv::Mat> frames(batch, gray);
+            auto t0 = std::chrono::steady_clock::now();
+            auto perImage = detector->detectBatch(frames);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << "Batch of " << batch << ": " << ms << " ms, keypoints per image:";
+            for (const auto& list : perImage) std::cout << " " << list.size();
+            std::cout << "\n";
+        }
 
-    VK_CHECK(vkEndCommandBuffer(cmdBuf), "vkEndCommandBuffer");
-    {
-        VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO}; si.commandBufferCount = 1; si.pCommandBuffers = &cmdBuf;
-        VK_CHECK(vkQueueSubmit(vk.computeQueue(), 1, &si, VK_NULL_HANDLE), "vkQueueSubmit");
-        VK_CHECK(vkQueueWaitIdle(vk.computeQueue()), "vkQueueWaitIdle");
+        // Streaming: keep up to framesInFlight frames on the GPU while collecting the oldest
+        if (repeat > 0 && gpu) {
+            FastDetector& det = *gpu;
+            size_t total = 0;
+            // Threshold step towards --target; applies to the next submit (push constant, no rebuild)
+            auto collectOne = [&] {
+                const size_t n = det.collect().size();
+                total += n;
+                if (target > 0 && n != size_t(target)) {
+                    const uint32_t t = det.options().threshold;
+                    det.setThreshold(n > size_t(target) ? t + 1 : (t > 1 ? t - 1 : t));
+                }
+            };
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < repeat; ++i) {
+                if (det.inFlight() == det.framesInFlight()) collectOne();
+                det.submit(gray);
+            }
+            while (det.inFlight() > 0) collectOne();
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << repeat << " frames, " << det.framesInFlight() << " in flight: "
+                      << repeat / sec << " fps (" << total / repeat << " keypoints/frame";
+            if (target > 0) std::cout << ", final threshold " << det.options().threshold;
+            std::cout << ")\n";
+        } else if (repeat > 0) {
+            size_t total = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < repeat; ++i) total += detector->detect(gray).size();
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << repeat << " frames on " << detector->name() << ": "
+                      << repeat / sec << " fps (" << total / repeat << " keypoints/frame)\n";
+        }
     }
 
-    // ----- 11) Readback outImage -> buffer -> save as out.png -----
-    VkBuffer readback{};
-    VkDeviceMemory readMem{};
-    {
-        VkBufferCreateInfo bi{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-        bi.size = imageSize; bi.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-        VK_CHECK(vkCreateBuffer(vk.device(), &bi, nullptr, &readback), "vkCreateBuffer(readback)");
-        VkMemoryRequirements mr{}; vkGetBufferMemoryRequirements(vk.device(), readback, &mr);
-        VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-        mai.allocationSize = mr.size;
-        mai.memoryTypeIndex = findMemoryType(mr.memoryTypeBits, vk.physicalDevice(),
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        VK_CHECK(vkAllocateMemory(vk.device(), &mai, nullptr, &readMem), "vkAllocateMemory(readback)");
-        VK_CHECK(vkBindBufferMemory(vk.device(), readback, readMem, 0), "vkBindBufferMemory(readback)");
+    // Sequence: decode/map ahead while the ring holds framesInFlight frames on the GPU
+    if (!input.empty()) {
+        auto source = FrameSource::open(input, decodeThreads, prefetch);
+        size_t frames = 0, total = 0;
+        auto emit = [&](std::vector<Keypoint> list) {
+            total += list.size();
+            if (writer) writer->append(std::move(list), withDescriptors ? gpu->descriptors() : cv::Mat());
+        };
+        auto t0 = std::chrono::steady_clock::now();
+        for (cv::Mat frame = source->next(); !frame.empty(); frame = source->next()) {
+            if (gpu) {
+                if (gpu->inFlight() == gpu->framesInFlight()) emit(gpu->collect());
+                gpu->submit(frame);
+            } else {
+                emit(detector->detect(frame));
+            }
+            ++frames;
+        }
+        while (gpu && gpu->inFlight() > 0) emit(gpu->collect());
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << input << ": " << frames << " frames on " << detector->name() << ", "
+                  << (sec > 0 ? double(frames) / sec : 0.0) << " fps including input ("
+                  << (frames ? total / frames : 0) << " keypoints/frame)\n";
     }
-    {
-        VkCommandBuffer cmd = beginOneShot(vk.device(), cmdPool);
-        transitionImage(cmd, outImage,
-            VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-            VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
-            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
-
-        VkBufferImageCopy r{};
-        r.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
-        r.imageOffset = {0,0,0};
-        r.imageExtent = {width, height, 1};
-        vkCmdCopyImageToBuffer(cmd, outImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback, 1, &r);
 
-        endOneShot(vk.device(), vk.computeQueue(), cmdPool, cmd);
+    if (writer) {
+        writer->close();
+        std::cout << "Wrote " << writer->frameCount() << " frames of keypoints to " << keypointsOut << "\n";
     }
-    {
-        void* mapped = nullptr;
-        VK_CHECK(vkMapMemory(vk.device(), readMem, 0, imageSize, 0, &mapped), "vkMapMemory(readback)");
-        cv::Mat out(height, width, CV_8UC4, mapped); // RGBA
-        cv::Mat outBGR; cv::cvtColor(out, outBGR, cv::COLOR_RGBA2BGR);
-        cv::imwrite("out.png", outBGR);
-        vkUnmapMemory(vk.device(), readMem);
-        std::cout << "Wrote out.png\n";
+    if (telemetry && metrics) {
+        if (metricsOut.empty()) {
+            std::cout << telemetry->scrape();
+        } else {
+            std::ofstream out(metricsOut);
+            out << telemetry->scrape();
+            if (!out) {
+                std::cerr << "Cannot write " << metricsOut << std::endl;
+                return -1;
+            }
+            std::cout << "Wrote metrics to " << metricsOut << "\n";
+        }
+    }
+    if (telemetry && !traceOut.empty()) {
+        telemetry->writeTrace(traceOut);
+        std::cout << "Wrote trace to " << traceOut << "\n";
     }
-
-    // Schritt 12: Ressourcen freigeben (Aufräumen)
-    vkDeviceWaitIdle(vk.device());
-
-    vkDestroyBuffer(vk.device(), readback, nullptr);
-    vkFreeMemory(vk.device(), readMem, nullptr);
-
-    vkDestroyPipeline(vk.device(), pipeline, nullptr);
-    vkDestroyPipelineLayout(vk.device(), layout, nullptr);
-    vkDestroyShaderModule(vk.device(), sm, nullptr);
-
-    vkDestroyDescriptorPool(vk.device(), dpool, nullptr);
-    vkDestroyDescriptorSetLayout(vk.device(), dsl, nullptr);
-
-    vkDestroyImageView(vk.device(), inView, nullptr);
-    vkDestroyImageView(vk.device(), outView, nullptr);
-    vkDestroyImage(vk.device(), inImage, nullptr);
-    vkDestroyImage(vk.device(), outImage, nullptr);
-    vkFreeMemory(vk.device(), inMem, nullptr);
-    vkFreeMemory(vk.device(), outMem, nullptr);
-
-    vkDestroyBuffer(vk.device(), staging, nullptr);
-    vkFreeMemory(vk.device(), stagingMem, nullptr);
-
-    vkDestroyCommandPool(vk.device(), cmdPool, nullptr);
 
     return 0;
-}
\ No newline at end of file
+}
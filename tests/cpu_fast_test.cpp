@@ -0,0 +1,190 @@
+// CpuFastDetector against a naive segment test: every pattern, thresholds from
+// permissive to strict, widths that leave a scalar tail after the SIMD lanes,
+// ROIs with a row stride wider than the image, NMS, and one vs. many threads,
+// for every segment-test path this CPU can run (AVX2, SSE2 / NEON, scalar).
+// Host only, no GPU needed. Run through ctest or directly; exit code 0 = pass.
+#include <opencv2/core.hpp>
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <string>
+#include <cstdint>
+#include "CpuFastDetector.h"
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond, what)                                                         \
+    do {                                                                          \
+        if (!(cond)) {                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " << what << std::endl; \
+            ++failures;                                                           \
+        }                                                                         \
+    } while (0)
+
+// --- Reference -----------------------------------------------------------------
+// Written from the definition, independent of the scan in CpuFastDetector.cpp:
+// I is brighter if I > I0 + t and darker if I < I0 - t; a corner has `arc`
+// contiguous brighter (or darker) circle pixels; its score is the best arc by
+// its weakest difference.
+
+std::vector<std::pair<int, int>> circleOf(FastPattern pattern) {
+    switch (pattern) {
+    case FastPattern::Fast7_12:
+        return {{0,-2}, {1,-2}, {2,-1}, {2,0}, {2,1}, {1,2}, {0,2}, {-1,2}, {-2,1}, {-2,0}, {-2,-1}, {-1,-2}};
+    case FastPattern::Fast5_8:
+        return {{0,-1}, {1,-1}, {1,0}, {1,1}, {0,1}, {-1,1}, {-1,0}, {-1,-1}};
+    default:
+        return {{0,-3}, {1,-3}, {2,-2}, {3,-1}, {3,0}, {3,1}, {2,2}, {1,3},
+                {0,3}, {-1,3}, {-2,2}, {-3,1}, {-3,0}, {-3,-1}, {-2,-2}, {-1,-3}};
+    }
+}
+
+// -1 = no corner, otherwise the FAST score
+int referenceScore(const cv::Mat& img, int x, int y, FastPattern pattern, int t) {
+    const auto circle = circleOf(pattern);
+    const int n = int(circle.size()), arc = int(fastPatternInfo(pattern).arc);
+    const int I0 = img.at<uint8_t>(y, x);
+    std::vector<int> d(n);
+    for (int i = 0; i < n; ++i) d[i] = int(img.at<uint8_t>(y + circle[i].second, x + circle[i].first)) - I0;
+
+    bool corner = false;
+    int best = 0;
+    for (int s = 0; s < n; ++s) {
+        int mn = d[s], mx = d[s];
+        for (int k = 1; k < arc; ++k) {
+            mn = std::min(mn, d[(s + k) % n]);
+            mx = std::max(mx, d[(s + k) % n]);
+        }
+        if (mn > t || mx < -t) corner = true;
+        best = std::max(best, std::max(mn, -mx));
+    }
+    return corner ? best : -1;
+}
+
+using Corner = std::tuple<uint32_t, uint32_t, int>;   // x, y, score
+
+std::vector<Corner> reference(const cv::Mat& img, FastPattern pattern, int t, bool nms) {
+    const int b = int(kFastBorder);
+    std::vector<int> scores(size_t(img.rows) * img.cols, -1);
+    for (int y = b; y < img.rows - b; ++y)
+        for (int x = b; x < img.cols - b; ++x) scores[size_t(y) * img.cols + x] = referenceScore(img, x, y, pattern, t);
+
+    std::vector<Corner> out;
+    for (int y = 0; y < img.rows; ++y) {
+        for (int x = 0; x < img.cols; ++x) {
+            const int s = scores[size_t(y) * img.cols + x];
+            if (s < 0) continue;
+            bool keep = true;
+            for (int dy = -1; nms && keep && dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int qx = x + dx, qy = y + dy;
+                    if ((dx == 0 && dy == 0) || qx < 0 || qy < 0 || qx >= img.cols || qy >= img.rows) continue;
+                    if (scores[size_t(qy) * img.cols + qx] >= s) keep = false;
+                }
+            }
+            if (keep) out.emplace_back(uint32_t(x), uint32_t(y), s);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+std::vector<Corner> corners(const std::vector<Keypoint>& kps) {
+    std::vector<Corner> out;
+    for (const Keypoint& k : kps) out.emplace_back(k.x, k.y, int(k.score));
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+// --- Images ----------------------------------------------------------------------
+
+// Deterministic: blocks of random flat levels with noise on top, so there are
+// both clean corners and dense noise responses
+cv::Mat makeImage(int width, int height, uint32_t seed) {
+    uint32_t state = seed * 2654435761u + 1;
+    auto next = [&] { state = state * 1664525u + 1013904223u; return state >> 24; };
+    std::vector<uint8_t> levels(64);
+    for (uint8_t& l : levels) l = uint8_t(next());
+    cv::Mat img(height, width, CV_8UC1);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const int base = levels[size_t((y / 9) % 8) * 8 + size_t((x / 7) % 8)];
+            img.at<uint8_t>(y, x) = uint8_t(std::clamp(base + int(next() % 41) - 20, 0, 255));
+        }
+    }
+    return img;
+}
+
+const char* patternName(FastPattern p) {
+    return p == FastPattern::Fast7_12 ? "7_12" : p == FastPattern::Fast5_8 ? "5_8" : "9_16";
+}
+
+std::string simdPath;   // path under test
+
+void compare(const cv::Mat& img, FastPattern pattern, uint32_t threshold, bool nms, unsigned threads,
+             const char* what) {
+    CpuFastDetector::Options opts;
+    opts.simd = simdPath;
+    opts.threads = threads;
+    opts.pattern = pattern;
+    opts.threshold = threshold;
+    opts.nonmaxSuppression = nms;
+    opts.maxKeypoints = 1u << 22;
+    CpuFastDetector det(opts);
+    const auto got = corners(det.detect(img));
+    const auto want = reference(img, pattern, int(threshold), nms);
+    CHECK(got == want, simdPath << " " << what << " " << img.cols << "x" << img.rows << " pattern " << patternName(pattern)
+                            << " t=" << threshold << (nms ? " nms" : "") << ": " << got.size() << " corners, expected "
+                            << want.size());
+}
+
+void run() {
+    const FastPattern patterns[] = {FastPattern::Fast9_16, FastPattern::Fast7_12, FastPattern::Fast5_8};
+
+    // Widths around the 16 / 32 byte lanes leave 0..lanes-1 pixels for the scalar tail
+    for (int width : {7, 16, 38, 45, 70, 131}) {
+        const cv::Mat img = makeImage(width, 41, uint32_t(width));
+        for (FastPattern p : patterns) {
+            for (uint32_t t : {0u, 10u, 40u, 76u}) {
+                compare(img, p, t, false, 1, "dense");
+                compare(img, p, t, true, 1, "nms");
+            }
+        }
+    }
+
+    // Row stride wider than the image: an ROI of a larger frame
+    {
+        const cv::Mat frame = makeImage(200, 120, 7);
+        const cv::Mat roi = frame(cv::Rect(13, 5, 101, 77));
+        for (FastPattern p : patterns) compare(roi, p, 20, false, 1, "roi");
+    }
+
+    // Strips on several threads give the same set as one thread
+    {
+        const cv::Mat img = makeImage(317, 263, 11);
+        for (FastPattern p : patterns) {
+            compare(img, p, 20, false, 4, "threads");
+            compare(img, p, 20, true, 4, "threads");
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    for (const std::string& path : CpuFastDetector::simdPaths()) {
+        std::cout << "CPU FAST segment test: " << path << "\n";
+        simdPath = path;
+        run();
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}
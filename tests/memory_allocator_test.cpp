@@ -0,0 +1,423 @@
+// MemoryAllocator against a fake device: the vk* memory entry points it calls are
+// defined here, so the test links without a Vulkan loader or GPU. The fake checks
+// every bind (known memory, type allowed by memoryTypeBits, alignment, bounds),
+// catches double frees and leaks, and can fail vkAllocateMemory on request.
+// Run through ctest or directly; exit code 0 = pass.
+#include <vulkan/vulkan.h>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdint>
+#include "MemoryAllocator.h"
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond, what)                                                         \
+    do {                                                                          \
+        if (!(cond)) {                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " << what << std::endl; \
+            ++failures;                                                           \
+        }                                                                         \
+    } while (0)
+
+// Non-dispatchable handles are pointers on 64-bit targets and uint64_t elsewhere
+template <class H>
+H toHandle(uintptr_t v) {
+    if constexpr (std::is_pointer_v<H>) return reinterpret_cast<H>(v);
+    else return H(v);
+}
+template <class H>
+uintptr_t fromHandle(H h) {
+    if constexpr (std::is_pointer_v<H>) return reinterpret_cast<uintptr_t>(h);
+    else return uintptr_t(h);
+}
+
+// --- Fake device -------------------------------------------------------------------
+
+struct FakeMemory {
+    VkDeviceSize size = 0;
+    uint32_t type = 0;
+    std::unique_ptr<char[]> host;       // backing store while mapped
+    bool mapped = false;
+};
+
+struct FakeResource {
+    VkMemoryRequirements req{};
+    bool image = false;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+};
+
+struct FakeDevice {
+    VkPhysicalDeviceMemoryProperties props{};
+    std::map<uintptr_t, FakeMemory> memory;
+    std::map<uintptr_t, FakeResource> resources;
+    uintptr_t nextHandle = 0x1000;
+    uint64_t allocateCalls = 0;
+    int failNextAllocations = 0;
+    int errors = 0;                     // invalid calls seen by the fake
+
+    void error(const char* what) {
+        std::cerr << "fake device: " << what << std::endl;
+        ++errors;
+    }
+} dev;
+
+VkPhysicalDevice const kPhysicalDevice = toHandle<VkPhysicalDevice>(0x10);
+VkDevice const kDevice = toHandle<VkDevice>(0x20);
+
+// 0: device local, 1: host visible + coherent, 2: host visible + coherent + cached
+void resetDevice() {
+    dev = FakeDevice{};
+    dev.props.memoryTypeCount = 3;
+    dev.props.memoryTypes[0].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    dev.props.memoryTypes[1].propertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    dev.props.memoryTypes[2].propertyFlags =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+    dev.props.memoryTypes[1].heapIndex = dev.props.memoryTypes[2].heapIndex = 1;
+    dev.props.memoryHeapCount = 2;
+}
+
+uintptr_t makeResource(bool image, VkDeviceSize size, VkDeviceSize alignment, uint32_t typeBits) {
+    const uintptr_t h = dev.nextHandle++;
+    FakeResource& r = dev.resources[h];
+    r.req.size = size;
+    r.req.alignment = alignment;
+    r.req.memoryTypeBits = typeBits;
+    r.image = image;
+    return h;
+}
+
+VkBuffer makeBuffer(VkDeviceSize size, VkDeviceSize alignment = 16, uint32_t typeBits = 0x7) {
+    return toHandle<VkBuffer>(makeResource(false, size, alignment, typeBits));
+}
+
+VkImage makeImage(VkDeviceSize size, VkDeviceSize alignment = 1024, uint32_t typeBits = 0x7) {
+    return toHandle<VkImage>(makeResource(true, size, alignment, typeBits));
+}
+
+VkResult bind(uintptr_t resource, VkDeviceMemory memory, VkDeviceSize offset) {
+    auto r = dev.resources.find(resource);
+    auto m = dev.memory.find(fromHandle(memory));
+    if (r == dev.resources.end() || m == dev.memory.end()) {
+        dev.error("bind of an unknown resource or memory");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    const VkMemoryRequirements& req = r->second.req;
+    if (!(req.memoryTypeBits & (1u << m->second.type))) dev.error("bind to a memory type outside memoryTypeBits");
+    if (offset % req.alignment != 0) dev.error("bind offset violates the alignment");
+    if (offset + req.size > m->second.size) dev.error("bound range exceeds the allocation");
+    r->second.memory = memory;
+    r->second.offset = offset;
+    return VK_SUCCESS;
+}
+
+} // namespace
+
+// --- vk* entry points used by MemoryAllocator ------------------------------------------
+
+extern "C" {
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice physicalDevice,
+                                                               VkPhysicalDeviceMemoryProperties* props) {
+    if (physicalDevice != kPhysicalDevice) dev.error("unexpected physical device");
+    *props = dev.props;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements(VkDevice, VkBuffer buffer, VkMemoryRequirements* req) {
+    *req = dev.resources.at(fromHandle(buffer)).req;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements(VkDevice, VkImage image, VkMemoryRequirements* req) {
+    *req = dev.resources.at(fromHandle(image)).req;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindBufferMemory(VkDevice, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize offset) {
+    return bind(fromHandle(buffer), memory, offset);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory(VkDevice, VkImage image, VkDeviceMemory memory, VkDeviceSize offset) {
+    return bind(fromHandle(image), memory, offset);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* info,
+                                                const VkAllocationCallbacks*, VkDeviceMemory* memory) {
+    if (device != kDevice) dev.error("unexpected device");
+    if (dev.failNextAllocations > 0) {
+        --dev.failNextAllocations;
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+    if (info->memoryTypeIndex >= dev.props.memoryTypeCount) dev.error("invalid memory type");
+    ++dev.allocateCalls;
+    const uintptr_t h = dev.nextHandle++;
+    FakeMemory& m = dev.memory[h];
+    m.size = info->allocationSize;
+    m.type = info->memoryTypeIndex;
+    *memory = toHandle<VkDeviceMemory>(h);
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeMemory(VkDevice, VkDeviceMemory memory, const VkAllocationCallbacks*) {
+    if (memory == VK_NULL_HANDLE) return;
+    auto m = dev.memory.find(fromHandle(memory));
+    if (m == dev.memory.end()) {
+        dev.error("free of unknown or already freed memory");
+        return;
+    }
+    if (m->second.mapped) dev.error("memory freed while mapped");
+    dev.memory.erase(m);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(VkDevice, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size,
+                                           VkMemoryMapFlags, void** data) {
+    auto m = dev.memory.find(fromHandle(memory));
+    if (m == dev.memory.end() || m->second.mapped) {
+        dev.error("map of unknown or already mapped memory");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    if (!(dev.props.memoryTypes[m->second.type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+        dev.error("map of memory that is not host visible");
+    }
+    if (offset != 0 || size != VK_WHOLE_SIZE) dev.error("expected whole-allocation maps");
+    m->second.host.reset(new char[size_t(m->second.size)]);
+    m->second.mapped = true;
+    *data = m->second.host.get();
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUnmapMemory(VkDevice, VkDeviceMemory memory) {
+    auto m = dev.memory.find(fromHandle(memory));
+    if (m == dev.memory.end() || !m->second.mapped) {
+        dev.error("unmap of unknown or unmapped memory");
+        return;
+    }
+    m->second.mapped = false;
+    m->second.host.reset();
+}
+
+} // extern "C"
+
+namespace {
+
+constexpr VkDeviceSize kBlock = VkDeviceSize(1) << 20;
+using Alloc = MemoryAllocator::Allocation;
+
+uint32_t typeOf(const Alloc& a) {
+    return dev.memory.at(fromHandle(a.memory)).type;
+}
+
+// --- Cases -------------------------------------------------------------------------
+
+void testSubAllocation() {
+    resetDevice();
+    MemoryAllocator alloc(kPhysicalDevice, kDevice, kBlock);
+    VkBuffer buf = makeBuffer(1000, 64);
+    Alloc a = alloc.allocateBuffer(buf, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    CHECK(a.size == 1024 && a.requested == 1000, "size class of 1000 bytes: " << a.size);
+    CHECK(a.block != MemoryAllocator::kDedicated && a.mapped == nullptr, "small device-local request sub-allocated");
+    CHECK(typeOf(a) == 0, "device-local request in type " << typeOf(a));
+    CHECK(dev.resources.at(fromHandle(buf)).memory == a.memory && dev.resources.at(fromHandle(buf)).offset == a.offset,
+          "buffer bound at the returned memory and offset");
+
+    Alloc b = alloc.allocateBuffer(makeBuffer(1000, 64), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    CHECK(b.memory == a.memory && b.offset != a.offset, "second request shares the block");
+    const MemoryAllocator::Stats s = alloc.stats();
+    CHECK(s.blocks == 1 && s.blockBytes == kBlock && s.deviceAllocations == 1, "one block for two small requests");
+    CHECK(s.liveAllocations == 2 && s.liveBytes == 2048 && s.requestedBytes == 2000, "live stats after two requests");
+    alloc.free(a);
+    alloc.free(b);
+    CHECK(a.memory == VK_NULL_HANDLE && b.memory == VK_NULL_HANDLE, "free resets the allocation");
+    CHECK(alloc.stats().liveAllocations == 0 && alloc.stats().liveBytes == 0 && alloc.stats().requestedBytes == 0,
+          "live stats after freeing everything");
+    alloc.free(a);   // freeing an empty allocation is a no-op
+}
+
+void testMemoryTypes() {
+    resetDevice();
+    MemoryAllocator alloc(kPhysicalDevice, kDevice, kBlock);
+    // Preferred flags win where a type has them, and are dropped otherwise
+    Alloc cached = alloc.allocateBuffer(makeBuffer(4096), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                        VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    CHECK(typeOf(cached) == 2, "preferred host-cached type, got " << typeOf(cached));
+    Alloc fallback = alloc.allocateBuffer(makeBuffer(4096, 16, 0x3), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                                          VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    CHECK(typeOf(fallback) == 1, "fallback without the preferred flag, got " << typeOf(fallback));
+
+    // Host-visible blocks are mapped once; the pointer is at the allocation's offset
+    Alloc second = alloc.allocateBuffer(makeBuffer(4096, 16, 0x2), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    const FakeMemory& m = dev.memory.at(fromHandle(fallback.memory));
+    CHECK(second.memory == fallback.memory, "same type shares the mapped block");
+    CHECK(m.mapped && fallback.mapped == m.host.get() + fallback.offset && second.mapped == m.host.get() + second.offset,
+          "mapped pointers at the allocation offsets");
+
+    bool threw = false;
+    try {
+        alloc.allocateBuffer(makeBuffer(256, 16, 0x1), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw, "no type satisfies the required flags: throws");
+    alloc.free(cached);
+    alloc.free(fallback);
+    alloc.free(second);
+}
+
+void testPools() {
+    resetDevice();
+    MemoryAllocator alloc(kPhysicalDevice, kDevice, kBlock);
+    // Buffers (linear) and optimal-tiling images never share a block
+    Alloc buf = alloc.allocateBuffer(makeBuffer(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    Alloc img = alloc.allocateImage(makeImage(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    CHECK(buf.memory != img.memory && buf.pool != img.pool, "buffer and image in separate pools");
+    CHECK(alloc.stats().blocks == 2, "one block per pool");
+    alloc.free(buf);
+    alloc.free(img);
+}
+
+void testReuse() {
+    resetDevice();
+    MemoryAllocator alloc(kPhysicalDevice, kDevice, kBlock);
+    Alloc keep = alloc.allocateBuffer(makeBuffer(3000), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    Alloc a = alloc.allocateBuffer(makeBuffer(3000), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    const VkDeviceSize offset = a.offset;
+    alloc.free(a);
+    Alloc b = alloc.allocateBuffer(makeBuffer(2500), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    CHECK(b.offset == offset && alloc.stats().reused == 1, "freed range serves the next request of its class");
+
+    // A block whose last range goes starts over for any class, without new device memory
+    alloc.free(keep);
+    alloc.free(b);
+    const uint64_t calls = dev.allocateCalls;
+    std::vector<Alloc> big;
+    for (int i = 0; i < 4; ++i) big.push_back(alloc.allocateBuffer(makeBuffer(kBlock / 4), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+    CHECK(dev.allocateCalls == calls && alloc.stats().blocks == 1, "emptied block reused for a new size class");
+    for (Alloc& x : big) alloc.free(x);
+}
+
+void testDedicated() {
+    resetDevice();
+    MemoryAllocator alloc(kPhysicalDevice, kDevice, kBlock);
+    Alloc a = alloc.allocateImage(makeImage(kBlock / 2 + 1), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    CHECK(a.block == MemoryAllocator::kDedicated && a.offset == 0, "request above half a block is dedicated");
+    CHECK(dev.memory.at(fromHandle(a.memory)).size == kBlock / 2 + 1, "dedicated allocation has the requested size");
+    CHECK(alloc.stats().dedicated == 1 && alloc.stats().dedicatedBytes == kBlock / 2 + 1 && alloc.stats().blocks == 0,
+          "dedicated stats");
+    Alloc mapped = alloc.allocateBuffer(makeBuffer(kBlock), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    CHECK(mapped.mapped == dev.memory.at(fromHandle(mapped.memory)).host.get(), "host-visible dedicated is mapped");
+    alloc.free(a);
+    alloc.free(mapped);
+    CHECK(dev.memory.empty() && alloc.stats().dedicated == 0 && alloc.stats().dedicatedBytes == 0,
+          "dedicated memory freed with its allocation");
+}
+
+void testTrimAndDestroy() {
+    resetDevice();
+    {
+        MemoryAllocator alloc(kPhysicalDevice, kDevice, kBlock);
+        Alloc a = alloc.allocateBuffer(makeBuffer(4096), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        Alloc b = alloc.allocateImage(makeImage(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        alloc.free(a);
+        alloc.trim();
+        CHECK(alloc.stats().blocks == 1 && dev.memory.size() == 1, "trim frees the empty block only");
+        alloc.free(b);
+        alloc.trim();
+        CHECK(alloc.stats().blocks == 0 && alloc.stats().blockBytes == 0 && dev.memory.empty(), "trim frees all empty blocks");
+
+        // Trimmed slots are refilled; the allocator still owns blocks when it goes
+        a = alloc.allocateBuffer(makeBuffer(4096), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        CHECK(alloc.stats().blocks == 1 && a.mapped != nullptr, "allocation after trim");
+    }
+    CHECK(dev.memory.empty(), "destructor frees (and unmaps) every block");
+}
+
+void testAllocationFailure() {
+    resetDevice();
+    MemoryAllocator alloc(kPhysicalDevice, kDevice, kBlock);
+    dev.failNextAllocations = 1;
+    bool threw = false;
+    try {
+        alloc.allocateBuffer(makeBuffer(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    const MemoryAllocator::Stats s = alloc.stats();
+    CHECK(threw && s.blocks == 0 && s.liveAllocations == 0 && s.deviceAllocations == 0, "failed vkAllocateMemory throws, no state");
+    Alloc a = alloc.allocateBuffer(makeBuffer(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    CHECK(a.memory != VK_NULL_HANDLE && alloc.stats().blocks == 1, "allocation after a failure");
+    alloc.free(a);
+}
+
+// Random buffers and images of mixed sizes, alignments and types; live ranges
+// never overlap and the stats always add up
+void testStress() {
+    resetDevice();
+    MemoryAllocator alloc(kPhysicalDevice, kDevice, kBlock);
+    std::mt19937 rng(1234);
+    std::vector<Alloc> live;
+    for (int step = 0; step < 20000; ++step) {
+        if (live.empty() || rng() % 100 < 55) {
+            const bool image = rng() % 2 == 0;
+            const VkDeviceSize size = 1 + rng() % (rng() % 8 == 0 ? kBlock : 64 * 1024);
+            const VkDeviceSize alignment = VkDeviceSize(1) << (rng() % 13);
+            const VkMemoryPropertyFlags flags = rng() % 3 == 0 ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                                               : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            live.push_back(image ? alloc.allocateImage(makeImage(size, alignment), flags)
+                                 : alloc.allocateBuffer(makeBuffer(size, alignment), flags));
+        } else {
+            const size_t i = rng() % live.size();
+            alloc.free(live[i]);
+            live[i] = live.back();
+            live.pop_back();
+        }
+        if (step % 500 == 0) alloc.trim();
+    }
+
+    VkDeviceSize liveBytes = 0, requestedBytes = 0;
+    std::map<uintptr_t, std::map<VkDeviceSize, VkDeviceSize>> ranges;   // memory -> offset -> end
+    bool overlap = false;
+    for (const Alloc& a : live) {
+        liveBytes += a.size;
+        requestedBytes += a.requested;
+        auto& r = ranges[fromHandle(a.memory)];
+        auto next = r.lower_bound(a.offset);
+        if (next != r.end() && next->first < a.offset + a.size) overlap = true;
+        if (next != r.begin() && std::prev(next)->second > a.offset) overlap = true;
+        r[a.offset] = a.offset + a.size;
+    }
+    const MemoryAllocator::Stats s = alloc.stats();
+    CHECK(!overlap, "live allocations overlap");
+    CHECK(s.liveAllocations == live.size() && s.liveBytes == liveBytes && s.requestedBytes == requestedBytes,
+          "stats match the live allocations");
+    CHECK(s.reused > 0, "free lists were used");
+    CHECK(dev.memory.size() == s.blocks + s.dedicated, "device memory matches blocks + dedicated");
+    for (Alloc& a : live) alloc.free(a);
+    alloc.trim();
+    CHECK(dev.memory.empty(), "everything freed after the stress run");
+}
+
+} // namespace
+
+int main() {
+    testSubAllocation();
+    testMemoryTypes();
+    testPools();
+    testReuse();
+    testDedicated();
+    testTrimAndDestroy();
+    testAllocationFailure();
+    testStress();
+
+    if (dev.errors > 0) std::cerr << dev.errors << " invalid call(s) seen by the fake device" << std::endl;
+    if (failures > 0 || dev.errors > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Reader utility for .kps keypoint streams (KeypointStream.h).
+//
+//   kps_dump FILE                       summary and keypoints per frame
+//   kps_dump FILE --frame=I             keypoints of frame I, one per line (x y score layer level [descriptor hex])
+//   kps_dump FILE --frame=I --draw=IMG --scale=S [--out=PNG]
+//                                       debug overlay of frame I on IMG, written as PNG (default kps_I.png);
+//                                       S is the detector's pyramidScale (default 2)
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include "KeypointStream.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: kps_dump FILE [--frame=I] [--draw=IMAGE] [--scale=S] [--out=PNG]" << std::endl;
+        return 1;
+    }
+    long frame = -1;
+    float scale = 2.0f;
+    std::string draw, out;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--frame=", 0) == 0) frame = std::atol(arg.c_str() + 8);
+        else if (arg.rfind("--draw=", 0) == 0) draw = arg.substr(7);
+        else if (arg.rfind("--scale=", 0) == 0) scale = std::strtof(arg.c_str() + 8, nullptr);
+        else if (arg.rfind("--out=", 0) == 0) out = arg.substr(6);
+        else std::cerr << "Unknown " << arg << std::endl;
+    }
+
+    try {
+        KeypointReader reader(argv[1]);
+        if (frame < 0) {
+            size_t total = 0;
+            for (size_t f = 0; f < reader.frameCount(); ++f) total += reader.count(f);
+            std::cout << argv[1] << ": " << reader.frameCount() << " frames, " << total << " keypoints, "
+                      << (reader.descriptorBytes() ? std::to_string(reader.descriptorBytes()) + "-byte descriptors"
+                                                   : std::string("no descriptors")) << "\n";
+            for (size_t f = 0; f < reader.frameCount(); ++f) {
+                std::cout << "  frame " << f << ": " << reader.count(f) << " keypoints";
+                if (reader.timestampNs(f) >= 0) std::cout << ", t = " << reader.timestampNs(f) << " ns";
+                std::cout << "\n";
+            }
+            return 0;
+        }
+
+        const size_t f = size_t(frame);
+        const Keypoint* kps = reader.keypoints(f);
+        const size_t n = reader.count(f);
+        if (draw.empty()) {
+            const cv::Mat desc = reader.descriptors(f);
+            for (size_t i = 0; i < n; ++i) {
+                std::printf("%u %u %g %u %u", kps[i].x, kps[i].y, kps[i].score, kps[i].layer, kps[i].level);
+                if (!desc.empty()) {
+                    std::printf(" ");
+                    for (int b = 0; b < desc.cols; ++b) std::printf("%02x", desc.at<uint8_t>(int(i), b));
+                }
+                std::printf("\n");
+            }
+            return 0;
+        }
+
+        // Opt-in debug overlay: same rings as main's out_CPU.png, at full resolution
+        cv::Mat color = cv::imread(draw, cv::IMREAD_COLOR);
+        if (color.empty()) {
+            std::cerr << "Cannot read " << draw << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const float s = std::pow(scale, float(kps[i].level));
+            const cv::Point center(int(std::lround(kps[i].x * s)), int(std::lround(kps[i].y * s)));
+            cv::circle(color, center, int(std::lround(6 * s)), cv::Scalar(0, 0, 255), 2, cv::LINE_AA);
+        }
+        if (out.empty()) out = "kps_" + std::to_string(f) + ".png";
+        if (!cv::imwrite(out, color)) {
+            std::cerr << "Cannot write " << out << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << out << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}